@@ -0,0 +1,660 @@
+// Offline benchmark for the load -> parse -> aggregate -> render pipeline.
+//
+// Synthetic PostgREST responses (10k/100k/1M messages by default, or the sizes
+// given on the command line) are served from an in-process httplib server on
+// loopback, so the dashboard's own fetch/parse/aggregate code runs unchanged.
+// Pages are rendered by DashboardApp::draw() onto an ncurses screen whose
+// output goes to /dev/null. Each stage reports wall time, heap allocations and
+// peak RSS.
+//
+// With --corpus, the messages, reactions, users and channels come from a
+// --replay event log instead (authors, channels, content and timestamps as
+// logged; ids are renumbered so the keyset paging stays contiguous).
+//
+//   ./build/comm0ns_tui_bench [messages...]
+//   ./build/comm0ns_tui_bench --corpus ~/.cache/comm0ns_tui/events-<hash>.log
+
+#define COMM0NS_TUI_NO_MAIN
+// One load connects every fetch slot at once; httplib's default backlog of 5
+// drops the extra SYNs and adds a one-second retransmit to the load stage.
+#define CPPHTTPLIB_LISTEN_BACKLOG 64
+#include "../src/main.cpp"
+
+#include <cinttypes>
+
+// Allocation counts and peak RSS come from main.cpp's perf instrumentation
+// (alloc_totals, peak_rss_kb).
+namespace {
+
+// Keeps benchmarked results observable so the loops are not optimized away.
+volatile long long g_sink = 0;
+
+// Wall time and allocation delta of one stage. Allocation counts are process
+// wide, so stages that go through HTTP include the server thread's share.
+class StageTimer {
+public:
+    StageTimer()
+        : start_(std::chrono::steady_clock::now()),
+          allocs_(alloc_totals()) {}
+
+    void report(const std::string& stage, size_t messages, int iterations = 1) const {
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+        const AllocTotals totals = alloc_totals();
+        const uint64_t allocs = totals.count - allocs_.count;
+        const uint64_t bytes = totals.bytes - allocs_.bytes;
+        std::printf("%-22s %9zu %12.3f %14" PRIu64 " %12.1f %10.1f\n",
+                    stage.c_str(), messages, ms / iterations,
+                    allocs / static_cast<uint64_t>(iterations),
+                    static_cast<double>(bytes) / iterations / 1024.0,
+                    static_cast<double>(peak_rss_kb()) / 1024.0);
+        std::fflush(stdout);
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+    AllocTotals allocs_;
+};
+
+// Deterministic community: message i (1-based) is posted by a pseudo-random
+// user into a pseudo-random channel, timestamps ascending over the last 90 days.
+class SyntheticDataset {
+public:
+    explicit SyntheticDataset(size_t messages)
+        : messages_(messages),
+          users_(std::max<size_t>(200, messages / 50)),
+          reactions_(messages / 2),
+          base_epoch_(std::time(nullptr) - 90 * 86400) {}
+
+    // Replaces the synthetic community with the events of a --replay log.
+    bool load_corpus(const std::string& path, std::string& error) {
+        EventLogView log;
+        if (!log.open(path, error)) {
+            return false;
+        }
+        std::vector<size_t> order;
+        for (size_t i = 0; i < log.size(); ++i) {
+            if (log[i].kind == static_cast<uint8_t>(EventKind::Message) ||
+                log[i].kind == static_cast<uint8_t>(EventKind::Reaction)) {
+                order.push_back(i);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return log[a].time < log[b].time; });
+
+        std::unordered_map<int64_t, size_t> user_index;
+        auto intern_user = [&](int64_t id) {
+            auto [it, inserted] = user_index.emplace(id, corpus_users_.size());
+            if (inserted) {
+                corpus_users_.push_back({"member" + std::to_string(corpus_users_.size()), -1.0});
+            }
+            return it->second;
+        };
+        std::unordered_map<int64_t, size_t> message_index;
+        for (size_t i = 0; i < log.size(); ++i) {
+            const EventRecord& r = log[i];
+            if (r.kind == static_cast<uint8_t>(EventKind::Channel)) {
+                if (r.channel >= corpus_channels_.size()) {
+                    corpus_channels_.resize(r.channel + 1);
+                }
+                std::string_view name = log.text(r);
+                if (!name.empty() && name.front() == '#') {
+                    name.remove_prefix(1);
+                }
+                corpus_channels_[r.channel] = std::string(name);
+            } else if (r.kind == static_cast<uint8_t>(EventKind::User)) {
+                CorpusUser& user = corpus_users_[intern_user(r.id)];
+                user.name = std::string(log.text(r));
+                user.score = static_cast<double>(r.actor) / 100.0;
+            }
+        }
+        for (size_t i : order) {
+            const EventRecord& r = log[i];
+            if (r.kind == static_cast<uint8_t>(EventKind::Message)) {
+                if (r.channel >= corpus_channels_.size()) {
+                    corpus_channels_.resize(r.channel + 1);
+                }
+                message_index.emplace(r.id, corpus_messages_.size() + 1);
+                corpus_messages_.push_back({r.time, intern_user(r.actor), r.channel, std::string(log.text(r))});
+            } else {
+                auto it = message_index.find(r.id);
+                corpus_reactions_.push_back({r.time, intern_user(r.actor), it != message_index.end() ? it->second : 1});
+            }
+        }
+        if (corpus_messages_.empty()) {
+            error = path + ": no messages logged";
+            return false;
+        }
+        for (size_t c = 0; c < corpus_channels_.size(); ++c) {
+            if (corpus_channels_[c].empty()) {
+                corpus_channels_[c] = "channel-" + std::to_string(c);
+            }
+        }
+        messages_ = corpus_messages_.size();
+        users_ = corpus_users_.size();
+        reactions_ = corpus_reactions_.size();
+        return true;
+    }
+
+    size_t messages() const { return messages_; }
+    size_t users() const { return users_; }
+    size_t reactions() const { return reactions_; }
+
+    long long message_id(size_t i) const { return 1000000000000000000LL + static_cast<long long>(i); }
+    long long user_id(size_t u) const { return 100000000000000000LL + static_cast<long long>(u); }
+    long long channel_id(size_t c) const { return 900000000000000000LL + static_cast<long long>(c); }
+
+    size_t author_of(size_t i) const {
+        return corpus_messages_.empty() ? mix(i) % users_ : corpus_message(i).author;
+    }
+    size_t channel_of(size_t i) const {
+        return corpus_messages_.empty() ? mix(i * 7 + 3) % channel_names().size() : corpus_message(i).channel;
+    }
+
+    std::string username(size_t u) const {
+        if (!corpus_users_.empty()) {
+            return corpus_users_[u % users_].name;
+        }
+        return (u % 5 == 0 ? "ユーザー" : "member") + std::to_string(u);
+    }
+
+    const std::string& content(size_t i) const {
+        if (!corpus_messages_.empty()) {
+            return corpus_message(i).content;
+        }
+        static const std::array<std::string, 6> texts = {
+            "lol",
+            "https://example.com/article worth a read",
+            std::string("Long-form notes on the governance proposal and its trade-offs. ") +
+                "Turnout thresholds, weighting and the VP curve all interact in subtle ways. " +
+                "Writing this down so the next sprint review has the full context.",
+            "hello there, anyone around for the sync?",
+            "草",
+            "deploy is done, please check the dashboard"
+        };
+        return texts[mix(i * 13 + 1) % texts.size()];
+    }
+
+    // ISO timestamps in PostgREST's fixed-offset form, so string order is time order.
+    std::string timestamp(size_t i) const {
+        if (!corpus_messages_.empty()) {
+            return format_iso_utc(corpus_message(i).time);
+        }
+        const double span = 90.0 * 86400.0;
+        const std::time_t t = base_epoch_ + static_cast<std::time_t>(span * static_cast<double>(i) / static_cast<double>(messages_ + 1));
+        std::tm tmv{};
+        gmtime_r(&t, &tmv);
+        char buf[40];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S+00:00", &tmv);
+        return buf;
+    }
+
+    const std::vector<std::string>& channel_names() const {
+        if (!corpus_channels_.empty()) {
+            return corpus_channels_;
+        }
+        static const std::vector<std::string> names = {
+            "general", "dev", "random", "ops", "learning", "雑談", "agri", "book-commons",
+            "article-share", "intro", "game", "music", "governance", "announcements", "sprint", "help"
+        };
+        return names;
+    }
+
+    // Page of the messages table from message index `first` (1-based).
+    std::string messages_page(size_t first, size_t limit) const {
+        std::string body = "[";
+        for (size_t i = first; i <= messages_ && i < first + limit; ++i) {
+            if (i != first) body += ',';
+            body += "{\"message_id\":" + std::to_string(message_id(i)) +
+                    ",\"user_id\":" + std::to_string(user_id(author_of(i))) +
+                    ",\"channel_id\":" + std::to_string(channel_id(channel_of(i))) +
+                    ",\"content\":" + nlohmann::json(content(i)).dump() +
+                    ",\"timestamp\":\"" + timestamp(i) + "\"}";
+        }
+        body += "]";
+        return body;
+    }
+
+    // Synthetic reaction r reacts to message 2r, so created_at ascends with r;
+    // corpus reactions keep their own time and message.
+    size_t reacted_message(size_t r) const {
+        return corpus_reactions_.empty() ? 2 * r : corpus_reactions_[r - 1].message;
+    }
+    size_t reactor_of(size_t r) const {
+        return corpus_reactions_.empty() ? mix(r * 31) % users_ : corpus_reactions_[r - 1].reactor;
+    }
+    std::string reaction_timestamp(size_t r) const {
+        return corpus_reactions_.empty() ? timestamp(2 * r) : format_iso_utc(corpus_reactions_[r - 1].time);
+    }
+
+    std::string reactions_page(size_t first, size_t limit) const {
+        std::string body = "[";
+        for (size_t r = first; r <= reactions_ && r < first + limit; ++r) {
+            if (r != first) body += ',';
+            char id[24];
+            std::snprintf(id, sizeof(id), "r%012zu", r);
+            body += "{\"message_id\":" + std::to_string(message_id(reacted_message(r))) +
+                    ",\"user_id\":" + std::to_string(user_id(reactor_of(r))) +
+                    ",\"created_at\":\"" + reaction_timestamp(r) + "\",\"id\":\"" + id + "\"}";
+        }
+        body += "]";
+        return body;
+    }
+
+    std::string users_page(size_t first, size_t limit) const {
+        std::string body = "[";
+        for (size_t u = first; u < users_ && u < first + limit; ++u) {
+            if (u != first) body += ',';
+            body += "{\"user_id\":" + std::to_string(user_id(u)) +
+                    ",\"username\":" + nlohmann::json(username(u)).dump() +
+                    ",\"current_score\":" + score(u) +
+                    ",\"weekly_score\":" + std::to_string(mix(u * 19) % 300) + "}";
+        }
+        body += "]";
+        return body;
+    }
+
+    std::string channels_page(size_t first, size_t limit) const {
+        const auto& names = channel_names();
+        std::string body = "[";
+        for (size_t c = first; c < names.size() && c < first + limit; ++c) {
+            if (c != first) body += ',';
+            body += "{\"channel_id\":" + std::to_string(channel_id(c)) +
+                    ",\"name\":" + nlohmann::json(names[c]).dump() + "}";
+        }
+        body += "]";
+        return body;
+    }
+
+    // First 1-based message / reaction whose timestamp is >= `mark` (keyset
+    // `gte.` filters).
+    size_t first_message_at_or_after(const std::string& mark) const {
+        return first_at_or_after(mark, messages_, [this](size_t i) { return timestamp(i); });
+    }
+    size_t first_reaction_at_or_after(const std::string& mark) const {
+        return first_at_or_after(mark, reactions_, [this](size_t r) { return reaction_timestamp(r); });
+    }
+
+private:
+    struct CorpusMessage {
+        int64_t time;
+        size_t author;
+        size_t channel;
+        std::string content;
+    };
+    struct CorpusReaction {
+        int64_t time;
+        size_t reactor;
+        size_t message;
+    };
+    struct CorpusUser {
+        std::string name;
+        double score;  // negative until a User record is seen
+    };
+
+    size_t messages_;
+    size_t users_;
+    size_t reactions_;
+    std::time_t base_epoch_;
+    std::vector<CorpusMessage> corpus_messages_;
+    std::vector<CorpusReaction> corpus_reactions_;
+    std::vector<CorpusUser> corpus_users_;
+    std::vector<std::string> corpus_channels_;
+
+    const CorpusMessage& corpus_message(size_t i) const {
+        return corpus_messages_[(i + messages_ - 1) % messages_];
+    }
+
+    std::string score(size_t u) const {
+        if (!corpus_users_.empty() && corpus_users_[u].score >= 0.0) {
+            return format_double(corpus_users_[u].score, 2);
+        }
+        return std::to_string(mix(u * 17) % 4000) + ".5";
+    }
+
+    template <typename Timestamp>
+    static size_t first_at_or_after(const std::string& mark, size_t count, Timestamp timestamp) {
+        size_t lo = 1;
+        size_t hi = count + 1;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (timestamp(mid) < mark) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    static size_t mix(size_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+};
+
+// Minimal PostgREST stand-in: keyset filters (`gt.` / `gte.`) and `limit` on
+// the tables the dashboard pages through; analytics views exist but are empty.
+class SyntheticServer {
+public:
+    explicit SyntheticServer(const SyntheticDataset& data) : data_(data) {
+        // Every fetch slot keeps its connection alive, each pinning a worker.
+        server_.new_task_queue = [] { return new httplib::ThreadPool(64); };
+        // Serve every body uncompressed: with zlib / brotli linked, httplib would
+        // brotli-encode each response on the server thread and bill that to the
+        // load stages. The bench therefore does not measure the client's gzip / br
+        // decoding. The request is a non-const local of httplib's, so dropping
+        // its header here is safe.
+        server_.set_pre_routing_handler([](const httplib::Request& req, httplib::Response&) {
+            const_cast<httplib::Request&>(req).headers.erase("Accept-Encoding");
+            return httplib::Server::HandlerResponse::Unhandled;
+        });
+        server_.Get(R"(/rest/v1/(\w+))", [this](const httplib::Request& req, httplib::Response& res) {
+            handle(req, res);
+        });
+        port_ = server_.bind_to_any_port("127.0.0.1");
+        thread_ = std::thread([this]() { server_.listen_after_bind(); });
+    }
+
+    ~SyntheticServer() {
+        server_.stop();
+        thread_.join();
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port_); }
+
+private:
+    const SyntheticDataset& data_;
+    httplib::Server server_;
+    std::thread thread_;
+    int port_ = 0;
+
+    static std::string filter(const httplib::Request& req, const std::string& key, bool& inclusive) {
+        auto it = req.params.find(key);
+        if (it == req.params.end()) {
+            return {};
+        }
+        const std::string& value = it->second;
+        inclusive = value.rfind("gte.", 0) == 0;
+        return value.substr(value.find('.') + 1);
+    }
+
+    void handle(const httplib::Request& req, httplib::Response& res) {
+        const std::string table = req.matches[1];
+        const size_t limit = req.has_param("limit") ? std::stoul(req.get_param_value("limit")) : kPageSize;
+        bool inclusive = false;
+        std::string body;
+
+        if (table == "messages") {
+            size_t first = 1;
+            const std::string after_id = filter(req, "message_id", inclusive);
+            const std::string since = filter(req, "timestamp", inclusive);
+            if (!after_id.empty()) {
+                first = static_cast<size_t>(std::stoll(after_id) - data_.message_id(0)) + 1;
+            } else if (!since.empty()) {
+                first = data_.first_message_at_or_after(since);
+            }
+            body = data_.messages_page(first, limit);
+        } else if (table == "reactions") {
+            size_t first = 1;
+            const std::string after_id = filter(req, "id", inclusive);
+            const std::string since = filter(req, "created_at", inclusive);
+            if (!after_id.empty()) {
+                first = std::stoul(after_id.substr(1)) + 1;
+            } else if (!since.empty()) {
+                first = data_.first_reaction_at_or_after(since);
+            }
+            body = data_.reactions_page(first, limit);
+        } else if (table == "users") {
+            const std::string after = filter(req, "user_id", inclusive);
+            const size_t first = after.empty() ? 0 : static_cast<size_t>(std::stoll(after) - data_.user_id(0)) + 1;
+            body = data_.users_page(first, limit);
+        } else if (table == "channels") {
+            const std::string after = filter(req, "channel_id", inclusive);
+            const size_t first = after.empty() ? 0 : static_cast<size_t>(std::stoll(after) - data_.channel_id(0)) + 1;
+            body = data_.channels_page(first, limit);
+        } else if (table == "votes") {
+            body = R"([{"id":"v1","title":"Adopt the new VP curve","type":"major","yes_vp":120,"no_vp":40,"voters":90,"total_eligible":150,"days_left":3}])";
+        } else if (table == "issues") {
+            body = R"([{"id":1,"title":"Cache snapshot on disk","label":"perf","priority":"high","status":"open","assignee":"member5"},)"
+                   R"({"id":2,"title":"Render panels lazily","label":"perf","priority":"medium","status":"review","assignee":"member9"}])";
+        } else if (table == "members" || table.rfind("analytics_", 0) == 0) {
+            body = "[]";
+        } else {
+            res.status = 404;
+            body = R"({"message":"relation does not exist"})";
+        }
+        res.set_content(body, "application/json");
+    }
+};
+
+}  // namespace
+
+namespace {
+
+class PipelineBench {
+public:
+    explicit PipelineBench(size_t messages) : data_(messages) {}
+    explicit PipelineBench(SyntheticDataset data) : data_(std::move(data)) {}
+
+    void run() {
+        bench_parse_and_aggregate();
+        bench_classify();
+        bench_display_width();
+        bench_load_and_render();
+    }
+
+private:
+    SyntheticDataset data_;
+
+    // The messages stream as load_snapshot sees it: JSON pages projected into
+    // QueryResult, then folded into the aggregator. Page generation is untimed.
+    void bench_parse_and_aggregate() {
+        const QuerySpec spec = DashboardApp::messages_spec("");
+        ActivityAggregator activity;
+        ActivityAggregator::MessageBatch batch;
+        AggregationPool pool;
+        double parse_ms = 0.0;
+        double fold_ms = 0.0;
+        uint64_t parse_allocs = 0;
+        uint64_t fold_allocs = 0;
+        for (size_t first = 1; first <= data_.messages(); first += kPageSize) {
+            const std::string body = data_.messages_page(first, kPageSize);
+
+            auto t0 = std::chrono::steady_clock::now();
+            uint64_t a0 = alloc_totals().count;
+            QueryResult page(spec.fields);
+            page.reserve(0, body.size());
+            QueryResultSax sax(page, spec.fields);
+            nlohmann::json::sax_parse(body, &sax);
+            auto t1 = std::chrono::steady_clock::now();
+            uint64_t a1 = alloc_totals().count;
+
+            batch.clear();
+            for (size_t row = 0; row < page.size(); ++row) {
+                batch.add(page.integer(row, 0), activity.intern_user(page.integer(row, 1)),
+                          activity.intern_channel(page.integer(row, 2)), false, page.text(row, 3), page.text(row, 4),
+                          page.day(row, 4));
+            }
+            activity.fold_messages(batch, pool);
+            auto t2 = std::chrono::steady_clock::now();
+            parse_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            fold_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+            parse_allocs += a1 - a0;
+            fold_allocs += alloc_totals().count - a1;
+        }
+        std::printf("%-22s %9zu %12.3f %14" PRIu64 " %12s %10.1f\n", "parse (json->columns)", data_.messages(), parse_ms,
+                    parse_allocs, "-", static_cast<double>(peak_rss_kb()) / 1024.0);
+        const std::string fold_stage = "aggregate (fold x" + std::to_string(pool.threads()) + ")";
+        std::printf("%-22s %9zu %12.3f %14" PRIu64 " %12s %10.1f\n", fold_stage.c_str(), data_.messages(), fold_ms,
+                    fold_allocs, "-", static_cast<double>(peak_rss_kb()) / 1024.0);
+    }
+
+    void bench_classify() {
+        const auto& names = data_.channel_names();
+        std::vector<std::string> channels;
+        for (const auto& name : names) {
+            channels.push_back("#" + name);
+        }
+        int insight = 0;
+        StageTimer timer;
+        for (size_t i = 1; i <= data_.messages(); ++i) {
+            insight += classify_stage1(is_ops_channel(channels[data_.channel_of(i)]), data_.content(i)) == Category::Insight;
+        }
+        timer.report("classify_stage1", data_.messages());
+        g_sink = insight;
+    }
+
+    void bench_display_width() {
+        std::vector<std::string> texts;
+        for (size_t u = 0; u < 1000; ++u) {
+            texts.push_back(data_.username(u));
+            texts.push_back(data_.content(u));
+        }
+        long long total = 0;
+        StageTimer timer;
+        for (size_t i = 0; i < data_.messages(); ++i) {
+            total += display_width_utf8(texts[i % texts.size()]);
+        }
+        timer.report("display_width_utf8", data_.messages());
+        g_sink = total;
+    }
+
+    // The dashboard's own worker path over loopback HTTP, then rendering.
+    void bench_load_and_render() {
+        SyntheticServer server(data_);
+        char cache_dir[] = "/tmp/comm0ns_bench_XXXXXX";
+        if (!mkdtemp(cache_dir)) {
+            std::perror("mkdtemp");
+            return;
+        }
+        setenv("COMM0NS_TUI_CACHE", cache_dir, 1);
+        unsetenv("SUPABASE_URL");
+        unsetenv("COMM0NS_TUI_FETCH");
+
+        // Constructed without credentials so the worker's first pass is a no-op;
+        // it is then parked for good and the stages drive load_snapshot directly.
+        DashboardApp app;
+        {
+            std::lock_guard<std::mutex> lock(app.refresh_mutex_);
+            app.refresh_stop_ = true;
+        }
+        app.refresh_cv_.notify_all();
+        app.refresh_worker_.join();
+        setenv("SUPABASE_URL", server.url().c_str(), 1);
+        setenv("SUPABASE_KEY", "bench", 1);
+
+        auto snap = std::make_unique<DashboardSnapshot>();
+        std::string error;
+        {
+            StageTimer timer;
+            if (!app.load_snapshot(*snap, error, true)) {
+                std::printf("load_snapshot failed: %s\n", error.c_str());
+                return;
+            }
+            timer.report("load_snapshot (full)", data_.messages());
+        }
+        {
+            DashboardSnapshot delta;
+            StageTimer timer;
+            app.load_snapshot(delta, error, false);
+            timer.report("load_snapshot (delta)", data_.messages());
+        }
+        {
+            StageTimer timer;
+            app.snapshot_cache_.store(*snap, app.activity_);
+            timer.report("snapshot cache store", data_.messages());
+        }
+        {
+            StageTimer timer;
+            app.apply_snapshot(*snap);
+            timer.report("apply_snapshot", data_.messages());
+        }
+        render_pages(app);
+        std::filesystem::remove_all(cache_dir);
+    }
+
+    void render_pages(DashboardApp& app) {
+        FILE* out = std::fopen("/dev/null", "w");
+        FILE* in = std::fopen("/dev/null", "r");
+        setenv("LINES", "50", 1);
+        setenv("COLUMNS", "160", 1);
+        SCREEN* screen = newterm(std::getenv("TERM") ? nullptr : "xterm-256color", out, in);
+        if (!screen) {
+            std::puts("render: newterm failed");
+            return;
+        }
+        set_term(screen);
+        if (has_colors()) {
+            start_color();
+            use_default_colors();
+        }
+
+        constexpr int kFrames = 20;
+        static const std::array<const char*, 5> names = {"overview", "members", "channels", "governance", "issues"};
+        for (int page = 1; page <= 5; ++page) {
+            app.page_ = page;
+            app.draw();
+            {
+                StageTimer timer;
+                for (int i = 0; i < kFrames; ++i) {
+                    app.invalidate_panels();
+                    app.draw();
+                }
+                timer.report(std::string("render ") + names[page - 1], data_.messages(), kFrames);
+            }
+            {
+                StageTimer timer;
+                for (int i = 0; i < kFrames; ++i) {
+                    app.draw();
+                }
+                timer.report(std::string("idle frame ") + names[page - 1], data_.messages(), kFrames);
+            }
+        }
+
+        app.destroy_panels();
+        endwin();
+        delscreen(screen);
+        std::fclose(out);
+        std::fclose(in);
+    }
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    setlocale(LC_ALL, "");
+    std::vector<size_t> sizes;
+    std::string corpus;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+            corpus = argv[++i];
+        } else {
+            sizes.push_back(static_cast<size_t>(std::stoull(argv[i])));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {10000, 100000, 1000000};
+    }
+
+    SyntheticDataset data(0);
+    if (!corpus.empty()) {
+        std::string error;
+        if (!data.load_corpus(corpus, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+
+    std::printf("%-22s %9s %12s %14s %12s %10s\n", "stage", "messages", "ms", "allocs", "alloc KiB", "peak MiB");
+    if (!corpus.empty()) {
+        PipelineBench(std::move(data)).run();
+        return 0;
+    }
+    for (size_t messages : sizes) {
+        PipelineBench(messages).run();
+    }
+    return 0;
+}
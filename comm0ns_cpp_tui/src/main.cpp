@@ -1,31 +1,65 @@
+// httplib/json must precede ncurses: its function-like macros (erase, clear, timeout)
+// collide with member functions in both headers.
+#include "httplib.h"
+#include "json.hpp"
+
 #include <ncurses.h>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <csignal>
+#include <condition_variable>
 #include <cctype>
+#include <cerrno>
+#include <charconv>
 #include <clocale>
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
 #include <cwchar>
+#include <deque>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <iomanip>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
 #include <numeric>
 #include <optional>
+#include <poll.h>
 #include <random>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
+#include <thread>
 #include <tuple>
+#include <unistd.h>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 namespace {
 
 enum class Category {
@@ -47,12 +81,24 @@ enum class SortKey {
     Ops
 };
 
+constexpr int kSortKeyCount = 8;
+constexpr size_t kCategoryCount = 5;
+
 enum class ChannelActivityRange {
     All,
     Month,
     Week
 };
 
+constexpr int kChannelActivityRangeCount = 3;
+
+// Overview activity window: the last hour by minute, day by hour, month by day.
+enum class ActivityZoom {
+    Hour,
+    Day,
+    Month
+};
+
 struct Member {
     std::string name;
     int cp;
@@ -66,6 +112,10 @@ struct Member {
     bool online;
     std::vector<std::string> titles;
     int votes_participated;
+    int active_week;   // active days among the last 7
+    int active_month;  // active days among the last 30
+    long long user_id = 0;  // 0 for the mock rows
+    int name_width = 0;  // display columns of name, measured on apply
 };
 
 struct Channel {
@@ -76,6 +126,8 @@ struct Channel {
     std::string champion;
     int active_users;
     double weight;
+    int name_width = 0;      // display columns of name/champion, measured on apply
+    int champion_width = 0;
 };
 
 struct Vote {
@@ -107,6 +159,8 @@ struct FeedItem {
 struct MessageSample {
     std::string channel;
     std::string text;
+    Category category = Category::Misc;  // Stage1 result, classified once when the message is folded, or Stage2's verdict
+    int stage2_percent = -1;  // confidence of a Stage2 verdict; -1 for a Stage1 result
 };
 
 struct RuleResult {
@@ -123,9 +177,31 @@ struct Sprint {
     int bonus_cp;
 };
 
+// Each listed member's messages per channel as unweighted CP (base_cp() summed
+// over them), channel-major: a weight change walks one contiguous column.
+// Basis of the Governance page's what-if scenarios.
+struct ScoringBasis {
+    std::vector<std::string> channels;
+    std::vector<double> weights;  // compiled-in weight of each channel
+    size_t member_count = 0;      // DashboardSnapshot::members, in order
+    std::vector<int> base_cp;     // [channel * member_count + member]
+};
+
+// Alternative weights (per ScoringBasis channel) and a TS multiplier.
+struct WhatIfScenario {
+    std::vector<double> weights;
+    double ts_scale = 1.0;
+};
+
+struct ScenarioScore {
+    int cp;
+    int vp;
+    int effective_vp;
+};
+
 constexpr int kMinHeight = 28;
 constexpr int kMinWidth = 104;
-constexpr int kHistoryWidth = 26;
+constexpr int kPageCount = 6;
 
 int clampi(int v, int lo, int hi) {
     return std::max(lo, std::min(v, hi));
@@ -138,58 +214,150 @@ std::string to_lower(std::string s) {
     return s;
 }
 
-bool contains_url(const std::string& text) {
-    return text.find("http://") != std::string::npos || text.find("https://") != std::string::npos;
-}
-
-std::string strip_non_basic(const std::string& text) {
-    std::string out;
-    out.reserve(text.size());
-    for (unsigned char ch : text) {
-        if (std::isalnum(ch) || std::isspace(ch) || std::ispunct(ch)) {
-            out.push_back(static_cast<char>(ch));
+// Stage1 works on bytes: the rules only look at ASCII (URL scheme, visible
+// ASCII characters, byte length), so no lowercase or filtered copy is needed.
+bool equals_ascii_ci(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
         }
     }
-    return out;
+    return true;
 }
 
-int visible_char_count(const std::string& text) {
-    int count = 0;
-    for (unsigned char ch : text) {
-        if (!std::isspace(ch)) {
-            ++count;
+// text[pos] is 'h' or 'H': does "http://" or "https://" (any case) start there?
+bool url_at(std::string_view text, size_t pos) {
+    const char* p = text.data() + pos + 1;
+    const char* end = text.data() + text.size();
+    for (char ch : {'t', 't', 'p'}) {
+        if (p == end || (*p | 0x20) != ch) {
+            return false;
         }
+        ++p;
+    }
+    if (p != end && (*p | 0x20) == 's') {
+        ++p;
     }
-    return count;
+    return end - p >= 3 && p[0] == ':' && p[1] == '/' && p[2] == '/';
+}
+
+// Printable ASCII other than space (what isgraph() accepts for bytes < 0x80).
+bool is_visible_ascii(unsigned char ch) {
+    return static_cast<unsigned>(ch - 0x21) < 0x5Eu;
 }
 
-const std::unordered_set<std::string> kOpsChannels = {
-    "#ops",
-    "#governance",
-    "#announcements",
-    "#sprint"
+struct TextScan {
+    bool has_url = false;
+    int visible = 0;  // only complete when has_url is false (the scan stops at a URL)
 };
 
-RuleResult rule_based_classify(const MessageSample& msg) {
-    const std::string normalized = to_lower(msg.text);
-    const std::string stripped = strip_non_basic(normalized);
+// Checks every set bit of an 'h'/'H' candidate mask for a URL.
+bool url_in_mask(std::string_view text, size_t base, uint32_t mask) {
+    while (mask != 0) {
+        if (url_at(text, base + static_cast<size_t>(__builtin_ctz(mask)))) {
+            return true;
+        }
+        mask &= mask - 1;
+    }
+    return false;
+}
 
-    if (contains_url(normalized)) {
-        return {Category::Info, 0.70, 1};
+// One pass over the text: URL candidates and visible characters are taken from
+// the same vector load (AVX2 when compiled for it, else SSE2, else scalar).
+TextScan scan_text(std::string_view text) {
+    TextScan scan;
+    size_t i = 0;
+#if defined(__AVX2__)
+    {
+        // Visible bytes 0x21..0x7E are shifted to the bottom of the signed range.
+        const __m256i bias = _mm256_set1_epi8(static_cast<char>(0x80 - 0x21));
+        const __m256i limit = _mm256_set1_epi8(static_cast<char>(0x80 + 0x5E));
+        const __m256i fold = _mm256_set1_epi8(0x20);
+        const __m256i h = _mm256_set1_epi8('h');
+        for (; i + 32 <= text.size(); i += 32) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i));
+            const uint32_t hmask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_or_si256(v, fold), h)));
+            if (hmask != 0 && url_in_mask(text, i, hmask)) {
+                scan.has_url = true;
+                return scan;
+            }
+            const __m256i visible = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(v, bias));
+            scan.visible += __builtin_popcount(static_cast<uint32_t>(_mm256_movemask_epi8(visible)));
+        }
     }
-    if (kOpsChannels.find(to_lower(msg.channel)) != kOpsChannels.end()) {
-        return {Category::Ops, 0.60, 1};
+#endif
+#if defined(__SSE2__)
+    {
+        const __m128i bias = _mm_set1_epi8(static_cast<char>(0x80 - 0x21));
+        const __m128i limit = _mm_set1_epi8(static_cast<char>(0x80 + 0x5E));
+        const __m128i fold = _mm_set1_epi8(0x20);
+        const __m128i h = _mm_set1_epi8('h');
+        for (; i + 16 <= text.size(); i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+            const uint32_t hmask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(v, fold), h)));
+            if (hmask != 0 && url_in_mask(text, i, hmask)) {
+                scan.has_url = true;
+                return scan;
+            }
+            const __m128i visible = _mm_cmplt_epi8(_mm_add_epi8(v, bias), limit);
+            scan.visible += __builtin_popcount(static_cast<uint32_t>(_mm_movemask_epi8(visible)));
+        }
     }
-    if (visible_char_count(stripped) < 5) {
-        return {Category::Vibe, 0.80, 1};
+#endif
+    for (; i < text.size(); ++i) {
+        const unsigned char ch = static_cast<unsigned char>(text[i]);
+        if ((ch | 0x20) == 'h' && url_at(text, i)) {
+            scan.has_url = true;
+            return scan;
+        }
+        scan.visible += is_visible_ascii(ch);
     }
-    if (normalized.size() > 200) {
-        return {Category::Insight, 0.40, 1};
+    return scan;
+}
+
+// Confidence and stage are fixed per category, so a stored category is a
+// complete Stage1 result.
+RuleResult stage1_result(Category category) {
+    switch (category) {
+        case Category::Info: return {Category::Info, 0.70, 1};
+        case Category::Ops: return {Category::Ops, 0.60, 1};
+        case Category::Vibe: return {Category::Vibe, 0.80, 1};
+        case Category::Insight: return {Category::Insight, 0.40, 1};
+        case Category::Misc: break;
     }
     return {Category::Misc, 0.00, 2};
 }
 
-int base_cp(Category c) {
+RuleResult sample_result(const MessageSample& sample) {
+    if (sample.stage2_percent >= 0) {
+        return {sample.category, sample.stage2_percent / 100.0, 2};
+    }
+    return stage1_result(sample.category);
+}
+
+// `ops_channel` is is_ops_channel() of the message's channel label, which
+// callers work out once per channel rather than once per message.
+Category classify_stage1(bool ops_channel, std::string_view text) {
+    const TextScan scan = scan_text(text);
+    if (scan.has_url) {
+        return Category::Info;
+    }
+    if (ops_channel) {
+        return Category::Ops;
+    }
+    if (scan.visible < 5) {
+        return Category::Vibe;
+    }
+    if (text.size() > 200) {
+        return Category::Insight;
+    }
+    return Category::Misc;
+}
+
+constexpr int base_cp(Category c) {
     switch (c) {
         case Category::Info: return 5;
         case Category::Insight: return 4;
@@ -200,38 +368,103 @@ int base_cp(Category c) {
     return 1;
 }
 
-const std::map<std::string, double> kChannelWeights = {
-    {"#dev", 1.2},
-    {"#agri", 1.2},
-    {"#book-commons", 1.2},
-    {"#learning", 1.2},
-    {"#article-share", 1.2},
-    {"#general", 1.0},
-    {"#intro", 1.0},
-    {"#game", 0.8},
-    {"#music", 0.8},
-    {"#random", 0.8}
+// Everything scoring needs to know about a channel, keyed by its normalized
+// label. `cp` is base_cp() times the weight, per Category.
+struct ChannelProfile {
+    std::string_view name;
+    double weight = 1.0;
+    bool ops = false;
+    std::array<double, kCategoryCount> cp{};
+};
+
+constexpr ChannelProfile make_channel_profile(std::string_view name, double weight, bool ops) {
+    ChannelProfile profile{name, weight, ops, {}};
+    for (size_t cat = 0; cat < kCategoryCount; ++cat) {
+        profile.cp[cat] = base_cp(static_cast<Category>(cat)) * weight;
+    }
+    return profile;
+}
+
+// Names are lowercase; lookups ignore ASCII case.
+constexpr std::array<ChannelProfile, 14> kChannelProfiles = {
+    make_channel_profile("#dev", 1.2, false),
+    make_channel_profile("#agri", 1.2, false),
+    make_channel_profile("#book-commons", 1.2, false),
+    make_channel_profile("#learning", 1.2, false),
+    make_channel_profile("#article-share", 1.2, false),
+    make_channel_profile("#general", 1.0, false),
+    make_channel_profile("#intro", 1.0, false),
+    make_channel_profile("#game", 0.8, false),
+    make_channel_profile("#music", 0.8, false),
+    make_channel_profile("#random", 0.8, false),
+    make_channel_profile("#ops", 1.0, true),
+    make_channel_profile("#governance", 1.0, true),
+    make_channel_profile("#announcements", 1.0, true),
+    make_channel_profile("#sprint", 1.0, true)
 };
 
-double channel_weight(const std::string& name) {
-    auto it = kChannelWeights.find(to_lower(name));
-    if (it == kChannelWeights.end()) {
-        return 1.0;
+constexpr ChannelProfile kDefaultChannelProfile = make_channel_profile("", 1.0, false);
+
+constexpr int kChannelSlotBits = 5;
+constexpr size_t kChannelSlots = size_t{1} << kChannelSlotBits;
+static_assert(kChannelSlots >= kChannelProfiles.size());
+
+// FNV-1a over the ASCII-lowercased bytes, salted so that kChannelProfiles lands
+// in kChannelSlots without collisions (the seed is searched at compile time).
+// The top bits pick the slot: FNV's low bits never see a change in the seed.
+constexpr size_t channel_slot(std::string_view name, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (char ch : name) {
+        h ^= static_cast<unsigned char>(ch >= 'A' && ch <= 'Z' ? ch + ('a' - 'A') : ch);
+        h *= 16777619u;
     }
-    return it->second;
+    return h >> (32 - kChannelSlotBits);
 }
 
-int streak_bonus(int streak_days) {
-    if (streak_days >= 30) {
-        return 15;
+constexpr uint32_t find_channel_seed() {
+    for (uint32_t seed = 0; seed < 4096; ++seed) {
+        std::array<bool, kChannelSlots> used{};
+        bool clash = false;
+        for (const ChannelProfile& profile : kChannelProfiles) {
+            bool& slot = used[channel_slot(profile.name, seed)];
+            clash = clash || slot;
+            slot = true;
+        }
+        if (!clash) {
+            return seed;
+        }
     }
-    if (streak_days >= 7) {
-        return 5;
+    return std::numeric_limits<uint32_t>::max();
+}
+
+constexpr uint32_t kChannelSeed = find_channel_seed();
+static_assert(kChannelSeed != std::numeric_limits<uint32_t>::max(), "no collision-free seed for kChannelProfiles");
+
+// Slot -> index into kChannelProfiles plus one (0 = empty).
+constexpr std::array<uint8_t, kChannelSlots> kChannelSlotTable = [] {
+    std::array<uint8_t, kChannelSlots> slots{};
+    for (size_t i = 0; i < kChannelProfiles.size(); ++i) {
+        slots[channel_slot(kChannelProfiles[i].name, kChannelSeed)] = static_cast<uint8_t>(i + 1);
     }
-    if (streak_days >= 3) {
-        return 2;
+    return slots;
+}();
+
+// Profile of a normalized channel label; kDefaultChannelProfile if unlisted.
+// Callers resolve this once per channel, not per message.
+const ChannelProfile& channel_profile(std::string_view label) {
+    const uint8_t slot = kChannelSlotTable[channel_slot(label, kChannelSeed)];
+    if (slot != 0 && equals_ascii_ci(kChannelProfiles[slot - 1].name, label)) {
+        return kChannelProfiles[slot - 1];
     }
-    return 0;
+    return kDefaultChannelProfile;
+}
+
+bool is_ops_channel(std::string_view label) {
+    return channel_profile(label).ops;
+}
+
+double channel_weight(std::string_view label) {
+    return channel_profile(label).weight;
 }
 
 int calc_vp(int cumulative_effective_cp) {
@@ -239,15 +472,59 @@ int calc_vp(int cumulative_effective_cp) {
     return clampi(vp, 1, 6);
 }
 
+int calc_effective_vp(int cp, int ts) {
+    const int vp = calc_vp(cp);
+    return std::max(1, static_cast<int>(std::floor(vp * (static_cast<double>(ts) / 100.0))));
+}
+
 int calc_effective_vp(const Member& m) {
-    const int vp = calc_vp(m.cp);
-    return std::max(1, static_cast<int>(std::floor(vp * (static_cast<double>(m.ts) / 100.0))));
+    return calc_effective_vp(m.cp, m.ts);
+}
+
+// effectiveCP = baseCP * channelWeight * (TS/100), from the weighted CP.
+double calc_effective_cp(double weighted_cp, int ts) {
+    return weighted_cp * (static_cast<double>(ts) / 100.0);
+}
+
+double calc_effective_cp(Category c, const ChannelProfile& channel, int ts) {
+    return calc_effective_cp(channel.cp[static_cast<size_t>(c)], ts);
 }
 
-double calc_effective_cp(Category c, const std::string& channel, int ts) {
-    const double cp = static_cast<double>(base_cp(c));
-    const double weighted = cp * channel_weight(channel);
-    return weighted * (static_cast<double>(ts) / 100.0);
+// Rescores every member under `scenario`: CP moves by the effective CP of each
+// channel's base CP at its weight change and the member's scaled TS. Only
+// changed channels are visited, each as one pass over a contiguous column. A
+// basis that does not match `members` contributes nothing.
+void score_scenario(
+    const ScoringBasis& basis,
+    const std::vector<Member>& members,
+    const WhatIfScenario& scenario,
+    std::vector<ScenarioScore>& out
+) {
+    const size_t n = members.size();
+    std::vector<int> ts(n);
+    for (size_t m = 0; m < n; ++m) {
+        ts[m] = clampi(static_cast<int>(std::round(members[m].ts * scenario.ts_scale)), 0, 100);
+    }
+    std::vector<double> delta(n, 0.0);
+    if (basis.member_count == n && scenario.weights.size() == basis.channels.size()) {
+        for (size_t ch = 0; ch < basis.channels.size(); ++ch) {
+            const double dw = scenario.weights[ch] - basis.weights[ch];
+            if (dw == 0.0) {
+                continue;
+            }
+            const int* column = basis.base_cp.data() + ch * n;
+            double* d = delta.data();
+            for (size_t m = 0; m < n; ++m) {
+                d[m] += calc_effective_cp(column[m] * dw, ts[m]);
+            }
+        }
+    }
+
+    out.resize(n);
+    for (size_t m = 0; m < n; ++m) {
+        const int cp = std::max(0, static_cast<int>(std::round(members[m].cp + delta[m])));
+        out[m] = {cp, calc_vp(cp), calc_effective_vp(cp, ts[m])};
+    }
 }
 
 std::string category_name(Category c) {
@@ -303,6 +580,137 @@ std::string sort_name(SortKey key) {
     return "CP";
 }
 
+// One precomputed permutation of the member list per SortKey, ordered by key
+// descending, then CP descending, then index. Sort keys (including the log2 VP)
+// are computed once per member per snapshot, so switching keys costs nothing.
+// A snapshot that changes only a few members' keys is merged in by
+// re-inserting just those members into each cached order.
+class MemberOrderIndex {
+public:
+    const std::vector<int>& order(SortKey key) const {
+        return orders_[static_cast<size_t>(key)];
+    }
+
+    void update(const std::vector<Member>& members) {
+        std::vector<Keys> keys;
+        keys.reserve(members.size());
+        for (const Member& m : members) {
+            keys.push_back(keys_of(m));
+        }
+        if (keys.size() != keys_.size()) {
+            rebuild(std::move(keys));
+            return;
+        }
+
+        std::vector<int> changed;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] != keys_[i]) {
+                changed.push_back(static_cast<int>(i));
+            }
+        }
+        if (changed.empty()) {
+            return;
+        }
+        // Each re-insert shifts the tail of the order, so past a handful of
+        // members one full sort is cheaper.
+        if (changed.size() * 8 > keys.size()) {
+            rebuild(std::move(keys));
+            return;
+        }
+
+        keys_ = std::move(keys);
+        std::vector<char> is_changed(keys_.size(), 0);
+        for (int i : changed) {
+            is_changed[static_cast<size_t>(i)] = 1;
+        }
+        for (int k = 0; k < kSortKeyCount; ++k) {
+            std::vector<int>& order = orders_[static_cast<size_t>(k)];
+            order.erase(std::remove_if(order.begin(), order.end(), [&](int i) {
+                return is_changed[static_cast<size_t>(i)] != 0;
+            }), order.end());
+            for (int i : changed) {
+                auto pos = std::lower_bound(order.begin(), order.end(), i, [&](int lhs, int rhs) {
+                    return precedes(k, lhs, rhs);
+                });
+                order.insert(pos, i);
+            }
+        }
+    }
+
+private:
+    // Every SortKey value plus CP as the tie-breaker.
+    using Keys = std::array<int, kSortKeyCount + 1>;
+
+    std::vector<Keys> keys_;
+    std::array<std::vector<int>, kSortKeyCount> orders_;
+
+    static Keys keys_of(const Member& m) {
+        Keys keys{};
+        keys[static_cast<size_t>(SortKey::Cp)] = m.cp;
+        keys[static_cast<size_t>(SortKey::Ts)] = m.ts;
+        keys[static_cast<size_t>(SortKey::Vp)] = calc_vp(m.cp);
+        keys[static_cast<size_t>(SortKey::Streak)] = m.streak;
+        keys[static_cast<size_t>(SortKey::Info)] = m.info;
+        keys[static_cast<size_t>(SortKey::Insight)] = m.insight;
+        keys[static_cast<size_t>(SortKey::Vibe)] = m.vibe;
+        keys[static_cast<size_t>(SortKey::Ops)] = m.ops;
+        keys[kSortKeyCount] = m.cp;
+        return keys;
+    }
+
+    bool precedes(int k, int lhs, int rhs) const {
+        const Keys& a = keys_[static_cast<size_t>(lhs)];
+        const Keys& b = keys_[static_cast<size_t>(rhs)];
+        if (a[k] != b[k]) {
+            return a[k] > b[k];
+        }
+        if (a[kSortKeyCount] != b[kSortKeyCount]) {
+            return a[kSortKeyCount] > b[kSortKeyCount];
+        }
+        return lhs < rhs;
+    }
+
+    void rebuild(std::vector<Keys> keys) {
+        keys_ = std::move(keys);
+        for (int k = 0; k < kSortKeyCount; ++k) {
+            std::vector<int>& order = orders_[static_cast<size_t>(k)];
+            order.resize(keys_.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+                return precedes(k, lhs, rhs);
+            });
+        }
+    }
+};
+
+// Member names, ASCII-lowercased and sorted, for the Members `/` search: a
+// prefix is one binary search plus the matching run.
+class NamePrefixIndex {
+public:
+    void rebuild(const std::vector<Member>& members) {
+        names_.clear();
+        names_.reserve(members.size());
+        for (size_t i = 0; i < members.size(); ++i) {
+            names_.push_back({to_lower(members[i].name), static_cast<int>(i)});
+        }
+        std::sort(names_.begin(), names_.end());
+    }
+
+    // fn(member index) for every name starting with `prefix` (lowercase).
+    template <typename Fn>
+    void for_each_match(std::string_view prefix, Fn fn) const {
+        auto it = std::lower_bound(names_.begin(), names_.end(), prefix, [](const auto& entry, std::string_view p) {
+            return std::string_view(entry.first) < p;
+        });
+        for (; it != names_.end() && std::string_view(it->first).substr(0, prefix.size()) == prefix; ++it) {
+            fn(it->second);
+        }
+    }
+
+private:
+    std::vector<std::pair<std::string, int>> names_;
+};
+
 int color_for_priority(const std::string& pri) {
     if (pri == "high" || pri == "critical") return 5;
     if (pri == "medium") return 4;
@@ -310,14 +718,6 @@ int color_for_priority(const std::string& pri) {
     return 1;
 }
 
-int color_for_status(const std::string& status) {
-    if (status == "review") return 2;
-    if (status == "in-progress") return 4;
-    if (status == "open") return 7;
-    if (status == "closed") return 3;
-    return 1;
-}
-
 int color_for_feed(const std::string& type) {
     if (type == "THNX") return 6;
     if (type == "INFO") return 2;
@@ -330,40 +730,6 @@ int color_for_feed(const std::string& type) {
     return 1;
 }
 
-void draw_box(int y, int x, int h, int w, const std::string& title, int color_pair) {
-    if (h < 3 || w < 4) {
-        return;
-    }
-    attron(COLOR_PAIR(color_pair));
-    mvhline(y, x + 1, ACS_HLINE, w - 2);
-    mvhline(y + h - 1, x + 1, ACS_HLINE, w - 2);
-    mvvline(y + 1, x, ACS_VLINE, h - 2);
-    mvvline(y + 1, x + w - 1, ACS_VLINE, h - 2);
-    mvaddch(y, x, ACS_ULCORNER);
-    mvaddch(y, x + w - 1, ACS_URCORNER);
-    mvaddch(y + h - 1, x, ACS_LLCORNER);
-    mvaddch(y + h - 1, x + w - 1, ACS_LRCORNER);
-
-    if (!title.empty() && w > 8) {
-        std::string t = " " + title + " ";
-        mvaddnstr(y, x + 2, t.c_str(), w - 4);
-    }
-    attroff(COLOR_PAIR(color_pair));
-}
-
-void put_line(int y, int x, int w, const std::string& text, int color_pair = 1, bool bold = false) {
-    if (w <= 0) {
-        return;
-    }
-    attr_t attr = COLOR_PAIR(color_pair);
-    if (bold) {
-        attr |= A_BOLD;
-    }
-    attron(attr);
-    mvaddnstr(y, x, text.c_str(), w);
-    attroff(attr);
-}
-
 std::string fit(const std::string& s, int w) {
     if (w <= 0) return "";
     if (static_cast<int>(s.size()) <= w) {
@@ -375,10 +741,38 @@ std::string fit(const std::string& s, int w) {
     return s.substr(0, w - 3) + "...";
 }
 
+// True when every byte is in 0x01..0x7F. Such text is one column per byte,
+// which lets the width helpers below skip mbrtowc/wcwidth entirely.
+bool is_plain_ascii(std::string_view text) {
+    const char* p = text.data();
+    const size_t n = text.size();
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        // Signed compare: NUL and every byte with the high bit set fail > 0.
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(bytes, zero)) != 0xFFFF) {
+            return false;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        const unsigned char ch = static_cast<unsigned char>(p[i]);
+        if (ch == 0 || ch >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
 int display_width_utf8(const std::string& text) {
     if (text.empty()) {
         return 0;
     }
+    if (is_plain_ascii(text)) {
+        return static_cast<int>(text.size());
+    }
     std::mbstate_t state{};
     const char* ptr = text.data();
     size_t len = text.size();
@@ -413,6 +807,9 @@ std::string truncate_utf8_by_width(const std::string& text, int max_width) {
     if (max_width <= 0 || text.empty()) {
         return "";
     }
+    if (is_plain_ascii(text)) {
+        return static_cast<int>(text.size()) <= max_width ? text : text.substr(0, max_width);
+    }
 
     std::mbstate_t state{};
     const char* ptr = text.data();
@@ -465,6 +862,86 @@ std::string pad_left_display(const std::string& text, int width) {
     return std::string(std::max(0, width - used), ' ') + clipped;
 }
 
+// Same, for snapshot strings whose display width was measured once on apply
+// (Member::name_width and friends): no decoding unless the cell truncates.
+std::string pad_right_display(const std::string& text, int width, int text_width) {
+    if (text_width > width) {
+        return pad_right_display(text, width);
+    }
+    std::string out;
+    out.reserve(text.size() + static_cast<size_t>(width - text_width));
+    out.append(text);
+    out.append(static_cast<size_t>(width - text_width), ' ');
+    return out;
+}
+
+// Window the draw helpers below paint into. Callers keep using screen
+// coordinates; a cached panel window just shifts them by its origin.
+struct DrawTarget {
+    WINDOW* win = nullptr;
+    int y0 = 0;
+    int x0 = 0;
+};
+
+DrawTarget& draw_target() {
+    static DrawTarget target;
+    return target;
+}
+
+void draw_box(int y, int x, int h, int w, const std::string& title, int color_pair) {
+    if (h < 3 || w < 4) {
+        return;
+    }
+    const DrawTarget& t = draw_target();
+    WINDOW* win = t.win ? t.win : stdscr;
+    y -= t.y0;
+    x -= t.x0;
+    wattron(win, COLOR_PAIR(color_pair));
+    mvwhline(win, y, x + 1, ACS_HLINE, w - 2);
+    mvwhline(win, y + h - 1, x + 1, ACS_HLINE, w - 2);
+    mvwvline(win, y + 1, x, ACS_VLINE, h - 2);
+    mvwvline(win, y + 1, x + w - 1, ACS_VLINE, h - 2);
+    mvwaddch(win, y, x, ACS_ULCORNER);
+    mvwaddch(win, y, x + w - 1, ACS_URCORNER);
+    mvwaddch(win, y + h - 1, x, ACS_LLCORNER);
+    mvwaddch(win, y + h - 1, x + w - 1, ACS_LRCORNER);
+
+    if (!title.empty() && w > 8) {
+        std::string label = " " + title + " ";
+        mvwaddnstr(win, y, x + 2, label.c_str(), w - 4);
+    }
+    wattroff(win, COLOR_PAIR(color_pair));
+}
+
+void put_line(int y, int x, int w, const std::string& text, int color_pair = 1, bool bold = false) {
+    if (w <= 0) {
+        return;
+    }
+    const DrawTarget& t = draw_target();
+    WINDOW* win = t.win ? t.win : stdscr;
+    attr_t attr = COLOR_PAIR(color_pair);
+    if (bold) {
+        attr |= A_BOLD;
+    }
+    // Clipped by display width: a panel window would wrap an overlong line
+    // (CJK names are two columns per character) into the next row.
+    const std::string clipped = truncate_utf8_by_width(text, w);
+    wattron(win, attr);
+    mvwaddstr(win, y - t.y0, x - t.x0, clipped.c_str());
+    wattroff(win, attr);
+}
+
+void fill_line(int y, int x, int w, int color_pair) {
+    if (w <= 0) {
+        return;
+    }
+    const DrawTarget& t = draw_target();
+    WINDOW* win = t.win ? t.win : stdscr;
+    wattron(win, COLOR_PAIR(color_pair));
+    mvwhline(win, y - t.y0, x - t.x0, ' ', w);
+    wattroff(win, COLOR_PAIR(color_pair));
+}
+
 std::string shell_quote(const std::string& value) {
     std::string out;
     out.reserve(value.size() + 8);
@@ -521,9 +998,8 @@ ShellResult run_shell(const std::string& command) {
     return result;
 }
 
-std::string unescape_tsv_field(const std::string& value) {
-    std::string out;
-    out.reserve(value.size());
+// Appends the jq @tsv field to `out`; escaped whitespace collapses to a space.
+void unescape_tsv_field(std::string& out, std::string_view value) {
     for (size_t i = 0; i < value.size(); ++i) {
         if (value[i] == '\\' && i + 1 < value.size()) {
             ++i;
@@ -540,46 +1016,6 @@ std::string unescape_tsv_field(const std::string& value) {
             out.push_back(value[i]);
         }
     }
-    return out;
-}
-
-std::vector<std::string> split_tsv_line(const std::string& line) {
-    std::vector<std::string> cols;
-    std::string cur;
-    for (char ch : line) {
-        if (ch == '\t') {
-            cols.push_back(unescape_tsv_field(cur));
-            cur.clear();
-        } else {
-            cur.push_back(ch);
-        }
-    }
-    cols.push_back(unescape_tsv_field(cur));
-    return cols;
-}
-
-int to_int(const std::string& value, int fallback = 0) {
-    try {
-        return std::stoi(value);
-    } catch (...) {
-        return fallback;
-    }
-}
-
-long long to_ll(const std::string& value, long long fallback = 0) {
-    try {
-        return std::stoll(value);
-    } catch (...) {
-        return fallback;
-    }
-}
-
-double to_double(const std::string& value, double fallback = 0.0) {
-    try {
-        return std::stod(value);
-    } catch (...) {
-        return fallback;
-    }
 }
 
 int days_from_civil(int year, unsigned month, unsigned day) {
@@ -605,21 +1041,104 @@ std::tuple<int, unsigned, unsigned> civil_from_days(int z) {
     return {year, month, day};
 }
 
-std::optional<int> parse_day_serial(const std::string& value) {
+// Leading-integer parse like std::stoll, without the allocation or exceptions.
+long long parse_ll(std::string_view value, long long fallback = 0) {
+    long long out = 0;
+    const auto res = std::from_chars(value.data(), value.data() + value.size(), out);
+    return res.ec == std::errc() ? out : fallback;
+}
+
+double parse_double(std::string_view value, double fallback = 0.0) {
+    double out = 0.0;
+    const auto res = std::from_chars(value.data(), value.data() + value.size(), out);
+    return res.ec == std::errc() ? out : fallback;
+}
+
+std::optional<int> parse_day_serial(std::string_view value) {
     if (value.size() < 10) {
         return std::nullopt;
     }
-    const int year = to_int(value.substr(0, 4), -1);
-    const int month = to_int(value.substr(5, 2), -1);
-    const int day = to_int(value.substr(8, 2), -1);
+    const int year = static_cast<int>(parse_ll(value.substr(0, 4), -1));
+    const int month = static_cast<int>(parse_ll(value.substr(5, 2), -1));
+    const int day = static_cast<int>(parse_ll(value.substr(8, 2), -1));
     if (year <= 0 || month <= 0 || month > 12 || day <= 0 || day > 31) {
         return std::nullopt;
     }
     return days_from_civil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
 }
 
+// Minutes since the Unix epoch (UTC) for an ISO timestamp, honouring a trailing
+// "+HH:MM"/"-HH:MM" offset; "Z" or no offset is taken as UTC.
+std::optional<long long> parse_epoch_minute(std::string_view value) {
+    const std::optional<int> day = parse_day_serial(value);
+    if (!day || value.size() < 16) {
+        return std::nullopt;
+    }
+    const int hour = static_cast<int>(parse_ll(value.substr(11, 2), -1));
+    const int minute = static_cast<int>(parse_ll(value.substr(14, 2), -1));
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+        return std::nullopt;
+    }
+    long long total = static_cast<long long>(*day) * 1440 + hour * 60 + minute;
+    const size_t sign = value.find_first_of("+-", 16);
+    if (sign != std::string_view::npos && value.size() >= sign + 3) {
+        const int offset_hours = static_cast<int>(parse_ll(value.substr(sign + 1, 2), 0));
+        const int offset_minutes = value.size() >= sign + 6 ? static_cast<int>(parse_ll(value.substr(sign + 4, 2), 0)) : 0;
+        const int offset = offset_hours * 60 + offset_minutes;
+        total += value[sign] == '+' ? -offset : offset;
+    }
+    return total;
+}
+
+// Seconds since the Unix epoch (UTC); seconds past the minute are optional.
+std::optional<long long> parse_epoch_second(std::string_view value) {
+    const std::optional<long long> minute = parse_epoch_minute(value);
+    if (!minute) {
+        return std::nullopt;
+    }
+    const int second = value.size() >= 19 && value[16] == ':' ? static_cast<int>(parse_ll(value.substr(17, 2), 0)) : 0;
+    return *minute * 60 + std::clamp(second, 0, 59);
+}
+
+// "YYYY-MM-DDTHH:MM:SS+00:00", the fixed-offset form PostgREST renders.
+std::string format_iso_utc(long long epoch_second) {
+    const long long day = epoch_second / 86400 - (epoch_second % 86400 < 0);
+    const int second_of_day = static_cast<int>(epoch_second - day * 86400);
+    const auto [year, month, mday] = civil_from_days(static_cast<int>(day));
+    char buf[48];  // fits any int year
+    std::snprintf(buf, sizeof(buf), "%04d-%02u-%02uT%02d:%02d:%02d+00:00", year, month, mday, second_of_day / 3600,
+                  second_of_day / 60 % 60, second_of_day % 60);
+    return buf;
+}
+
+// --replay pins the dashboard's "now" to the replay cursor, so the day and
+// minute windows follow it; zero means the wall clock.
+std::atomic<long long> g_replay_now{0};
+
+std::time_t dashboard_time() {
+    const long long pinned = g_replay_now.load(std::memory_order_relaxed);
+    return pinned ? static_cast<std::time_t>(pinned) : std::time(nullptr);
+}
+
+long long now_epoch_minute() {
+    return static_cast<long long>(dashboard_time()) / 60;
+}
+
+// "45s", "12m", "3h" or "2d" since `timestamp`; "?" when it does not parse.
+std::string age_label(std::string_view timestamp) {
+    const std::optional<long long> at = parse_epoch_second(timestamp);
+    if (!at) {
+        return "?";
+    }
+    const long long age = std::max(0LL, static_cast<long long>(dashboard_time()) - *at);
+    if (age < 60) return std::to_string(age) + "s";
+    if (age < 3600) return std::to_string(age / 60) + "m";
+    if (age < 86400) return std::to_string(age / 3600) + "h";
+    return std::to_string(age / 86400) + "d";
+}
+
 int today_day_serial() {
-    const std::time_t now = std::time(nullptr);
+    const std::time_t now = dashboard_time();
     std::tm tmv{};
 #if defined(_WIN32)
     localtime_s(&tmv, &now);
@@ -652,34 +1171,4779 @@ std::string normalize_channel_label(const std::string& name, long long channel_i
     return label;
 }
 
-class DashboardApp {
-public:
-    struct TabHit {
-        int x0;
-        int x1;
-        int page;
-    };
+std::string env_or_empty(const char* name) {
+    const char* value = std::getenv(name);
+    return value ? std::string(value) : std::string();
+}
 
-    struct MemberRowHit {
-        int y;
-        int x0;
-        int x1;
-        int row_index;
-    };
+// Heap allocation counters behind the perf page, /metrics and the bench. Each
+// thread counts into a cache line of its own, so allocating never touches a
+// line another thread writes; alloc_totals() sums the lines when read. Threads
+// past the last slot share it, which only costs them contention.
+struct alignas(64) AllocCounters {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> bytes{0};
+};
+constexpr size_t kAllocCounterSlots = 128;
+AllocCounters g_alloc_slots[kAllocCounterSlots];
+std::atomic<size_t> g_alloc_slots_used{0};
+thread_local AllocCounters* t_alloc_slot = nullptr;
+// This thread's allocations only, so a frame is not charged for the workers.
+thread_local uint64_t t_alloc_count = 0;
+
+struct AllocTotals {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
 
-    struct ChannelRangeHit {
-        int y;
-        int x0;
-        int x1;
-        ChannelActivityRange range;
-    };
+AllocTotals alloc_totals() {
+    AllocTotals totals;
+    const size_t used = std::min(g_alloc_slots_used.load(std::memory_order_relaxed), kAllocCounterSlots);
+    for (size_t i = 0; i < used; ++i) {
+        totals.count += g_alloc_slots[i].count.load(std::memory_order_relaxed);
+        totals.bytes += g_alloc_slots[i].bytes.load(std::memory_order_relaxed);
+    }
+    return totals;
+}
+
+// Counts, then allocates like the default operator new: retry through the
+// new-handler until it gives up (nullptr) or throws.
+void* counted_alloc(size_t size, size_t align) {
+    ++t_alloc_count;
+    if (!t_alloc_slot) {
+        const size_t slot = g_alloc_slots_used.fetch_add(1, std::memory_order_relaxed);
+        t_alloc_slot = &g_alloc_slots[std::min(slot, kAllocCounterSlots - 1)];
+    }
+    t_alloc_slot->count.fetch_add(1, std::memory_order_relaxed);
+    t_alloc_slot->bytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        void* p = nullptr;
+        if (align <= alignof(std::max_align_t)) {
+            p = std::malloc(size);
+        } else if (posix_memalign(&p, align, size) != 0) {
+            p = nullptr;
+        }
+        if (p) {
+            return p;
+        }
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            return nullptr;
+        }
+        handler();
+    }
+}
+
+void* counted_alloc_or_throw(size_t size, size_t align) {
+    if (void* p = counted_alloc(size, align)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* counted_alloc_nothrow(size_t size, size_t align) noexcept {
+    try {
+        return counted_alloc(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return counted_alloc_or_throw(size, 0); }
+void* operator new[](size_t size) { return counted_alloc_or_throw(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_alloc_nothrow(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_alloc_nothrow(size, 0); }
+void* operator new(size_t size, std::align_val_t align) { return counted_alloc_or_throw(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return counted_alloc_or_throw(size, static_cast<size_t>(align)); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc_nothrow(size, static_cast<size_t>(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc_nothrow(size, static_cast<size_t>(align));
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+namespace {
+
+using PerfClock = std::chrono::steady_clock;
+
+uint32_t elapsed_us(PerfClock::time_point start) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(PerfClock::now() - start).count();
+    return static_cast<uint32_t>(std::clamp<long long>(us, 0, std::numeric_limits<uint32_t>::max()));
+}
+
+// The last kSamples values of one measurement, for p50/p99 on the perf page.
+class SampleWindow {
+public:
+    static constexpr size_t kSamples = 128;
+
+    void add(uint32_t value) {
+        samples_[next_] = value;
+        next_ = (next_ + 1) % kSamples;
+        count_ = std::min(count_ + 1, kSamples);
+        last_ = value;
+    }
+
+    size_t count() const { return count_; }
+    uint32_t last() const { return last_; }
+
+    // Nearest-rank percentile over the window; 0 while empty.
+    uint32_t percentile(int pct) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        std::array<uint32_t, kSamples> sorted;
+        std::copy(samples_.begin(), samples_.begin() + static_cast<std::ptrdiff_t>(count_), sorted.begin());
+        const size_t rank = std::max<size_t>(1, (static_cast<size_t>(pct) * count_ + 99) / 100);
+        std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank - 1),
+                         sorted.begin() + static_cast<std::ptrdiff_t>(count_));
+        return sorted[rank - 1];
+    }
+
+private:
+    std::array<uint32_t, kSamples> samples_{};
+    size_t count_ = 0;
+    size_t next_ = 0;
+    uint32_t last_ = 0;
+};
+
+enum class PerfStage {
+    Load,        // whole load_snapshot
+    Parse,       // response body -> QueryResult, summed over the refresh
+    Aggregate,   // message/reaction pages folded into ActivityAggregator, summed
+    Build,       // snapshot tables assembled from the fetched results
+    CacheStore,
+    Apply
+};
+
+constexpr size_t kPerfStageCount = 6;
+
+const char* perf_stage_name(PerfStage stage) {
+    switch (stage) {
+        case PerfStage::Load: return "load";
+        case PerfStage::Parse: return "parse";
+        case PerfStage::Aggregate: return "aggregate";
+        case PerfStage::Build: return "build";
+        case PerfStage::CacheStore: return "cache store";
+        case PerfStage::Apply: return "apply";
+    }
+    return "?";
+}
+
+// Cumulative histogram in the Prometheus layout: per-bucket counts against
+// fixed upper bounds (seconds), plus sum and count.
+class Histogram {
+public:
+    explicit Histogram(std::vector<double> bounds) : bounds_(std::move(bounds)), counts_(bounds_.size(), 0) {}
+
+    void observe(double seconds) {
+        const auto it = std::lower_bound(bounds_.begin(), bounds_.end(), seconds);
+        if (it != bounds_.end()) {
+            ++counts_[static_cast<size_t>(it - bounds_.begin())];
+        }
+        sum_ += seconds;
+        ++count_;
+    }
+
+    const std::vector<double>& bounds() const { return bounds_; }
+    const std::vector<uint64_t>& counts() const { return counts_; }  // not cumulative
+    double sum() const { return sum_; }
+    uint64_t count() const { return count_; }
+
+private:
+    std::vector<double> bounds_;
+    std::vector<uint64_t> counts_;
+    double sum_ = 0.0;
+    uint64_t count_ = 0;
+};
+
+struct EndpointPerf {
+    SampleWindow latency_us;  // per request (one keyset page each)
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;  // received during the latest refresh
+    uint64_t rows = 0;
+    uint64_t bytes_total = 0;
+    uint64_t rows_total = 0;
+    uint64_t unchanged = 0;  // answered from the response cache (304 or same body)
+};
+
+struct PerfReport {
+    std::map<std::string, EndpointPerf> endpoints;
+    std::array<SampleWindow, kPerfStageCount> stages;
+    uint64_t refreshes = 0;
+    uint64_t refresh_failures = 0;  // outcomes the UI could not adopt
+    Histogram refresh_seconds{{0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0, 60.0}};
+    Histogram frame_seconds{{0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1}};
+    // Rows of each table in the adopted snapshot, and when it was adopted.
+    std::vector<std::pair<std::string, size_t>> snapshot_rows;
+    std::optional<std::chrono::system_clock::time_point> last_success;
+};
+
+// Fetch/refresh instrumentation, written from the refresh worker and fetch
+// slots and read by the perf page. Recording takes a short lock once per
+// request or stage, never per row, so it stays on in release builds.
+class PerfStats {
+public:
+    void begin_refresh() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : report_.endpoints) {
+            entry.second.bytes = 0;
+            entry.second.rows = 0;
+        }
+        pending_.fill(0);
+    }
+
+    // `us` is the whole load; stages summed across fetch threads land as one
+    // sample per refresh.
+    void end_refresh(uint32_t us) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_[static_cast<size_t>(PerfStage::Load)] = us;
+        report_.refresh_seconds.observe(static_cast<double>(us) / 1e6);
+        for (size_t i = 0; i < kPerfStageCount; ++i) {
+            if (pending_[i]) {
+                report_.stages[i].add(static_cast<uint32_t>(std::min<uint64_t>(pending_[i], std::numeric_limits<uint32_t>::max())));
+            }
+        }
+        ++report_.refreshes;
+        ++generation_;
+    }
+
+    void record_query(const std::string& endpoint, uint32_t us, size_t bytes, size_t rows, bool ok, bool unchanged = false) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        EndpointPerf& e = report_.endpoints[endpoint];
+        e.latency_us.add(us);
+        ++e.requests;
+        e.errors += ok ? 0 : 1;
+        e.unchanged += unchanged ? 1 : 0;
+        e.bytes += bytes;
+        e.rows += rows;
+        e.bytes_total += bytes;
+        e.rows_total += rows;
+    }
+
+    void record_frame(uint32_t us) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        report_.frame_seconds.observe(static_cast<double>(us) / 1e6);
+    }
+
+    void record_snapshot(std::vector<std::pair<std::string, size_t>> rows) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        report_.snapshot_rows = std::move(rows);
+        report_.last_success = std::chrono::system_clock::now();
+    }
+
+    void record_refresh_failure() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++report_.refresh_failures;
+    }
+
+    void record_stage(PerfStage stage, uint32_t us) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        report_.stages[static_cast<size_t>(stage)].add(us);
+        ++generation_;
+    }
+
+    void add_stage(PerfStage stage, uint32_t us) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_[static_cast<size_t>(stage)] += us;
+    }
+
+    // Bumped whenever a refresh or stage sample completes.
+    uint64_t generation() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return generation_;
+    }
+
+    PerfReport report() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return report_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    PerfReport report_;
+    std::array<uint64_t, kPerfStageCount> pending_{};
+    uint64_t generation_ = 0;
+};
+
+PerfStats& perf_stats() {
+    static PerfStats stats;
+    return stats;
+}
+
+// Times its scope into perf_stats(): as a sample of its own, or (summed) into
+// the current refresh's sample for stages that run piecewise across threads.
+class ScopedPerfTimer {
+public:
+    explicit ScopedPerfTimer(PerfStage stage, bool per_refresh = false)
+        : stage_(stage), per_refresh_(per_refresh), start_(PerfClock::now()) {}
+    ScopedPerfTimer(const ScopedPerfTimer&) = delete;
+    ScopedPerfTimer& operator=(const ScopedPerfTimer&) = delete;
+
+    ~ScopedPerfTimer() {
+        const uint32_t us = elapsed_us(start_);
+        if (per_refresh_) {
+            perf_stats().add_stage(stage_, us);
+        } else {
+            perf_stats().record_stage(stage_, us);
+        }
+    }
+
+private:
+    PerfStage stage_;
+    bool per_refresh_;
+    PerfClock::time_point start_;
+};
+
+// Brackets one load_snapshot: per-refresh byte/row counts start from zero, and
+// the load time and summed stages are recorded when it ends.
+class PerfRefreshScope {
+public:
+    PerfRefreshScope() : start_(PerfClock::now()) { perf_stats().begin_refresh(); }
+    PerfRefreshScope(const PerfRefreshScope&) = delete;
+    PerfRefreshScope& operator=(const PerfRefreshScope&) = delete;
+    ~PerfRefreshScope() { perf_stats().end_refresh(elapsed_us(start_)); }
+
+private:
+    PerfClock::time_point start_;
+};
+
+// Current resident set from /proc (0 where unavailable); peak from getrusage.
+long current_rss_kb() {
+    long pages = 0;
+    long resident = 0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        std::fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+long peak_rss_kb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Label values in the exposition format escape backslash, quote and newline.
+std::string prometheus_label(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (const char ch : value) {
+        if (ch == '\\' || ch == '"') {
+            out.push_back('\\');
+            out.push_back(ch);
+        } else if (ch == '\n') {
+            out += "\\n";
+        } else {
+            out.push_back(ch);
+        }
+    }
+    return out;
+}
+
+void prometheus_histogram(std::ostringstream& out, const char* name, const char* help, const Histogram& h) {
+    out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " histogram\n";
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < h.bounds().size(); ++i) {
+        cumulative += h.counts()[i];
+        out << name << "_bucket{le=\"" << h.bounds()[i] << "\"} " << cumulative << '\n';
+    }
+    out << name << "_bucket{le=\"+Inf\"} " << h.count() << '\n'
+        << name << "_sum " << h.sum() << '\n'
+        << name << "_count " << h.count() << '\n';
+}
+
+// GET /metrics body (Prometheus text format 0.0.4).
+std::string prometheus_text(const PerfReport& report) {
+    std::ostringstream out;
+    out << std::setprecision(9);
+    prometheus_histogram(out, "comm0ns_tui_refresh_duration_seconds",
+                         "Wall time of one Supabase refresh (load_snapshot).", report.refresh_seconds);
+    out << "# HELP comm0ns_tui_refresh_failures_total Refreshes that produced no snapshot.\n"
+           "# TYPE comm0ns_tui_refresh_failures_total counter\n"
+           "comm0ns_tui_refresh_failures_total " << report.refresh_failures << '\n';
+
+    const std::array<std::tuple<const char*, const char*, uint64_t EndpointPerf::*>, 5> endpoint_counters = {{
+        {"comm0ns_tui_query_requests_total", "PostgREST requests (one per keyset page).", &EndpointPerf::requests},
+        {"comm0ns_tui_query_errors_total", "PostgREST requests that failed.", &EndpointPerf::errors},
+        {"comm0ns_tui_query_unchanged_total", "Requests answered from the response cache.", &EndpointPerf::unchanged},
+        {"comm0ns_tui_query_rows_total", "Rows received.", &EndpointPerf::rows_total},
+        {"comm0ns_tui_query_bytes_total", "Response bytes received.", &EndpointPerf::bytes_total},
+    }};
+    for (const auto& [name, help, field] : endpoint_counters) {
+        out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " counter\n";
+        for (const auto& [endpoint, e] : report.endpoints) {
+            out << name << "{endpoint=\"" << prometheus_label(endpoint) << "\"} " << e.*field << '\n';
+        }
+    }
+
+    out << "# HELP comm0ns_tui_snapshot_rows Rows per table in the displayed snapshot.\n"
+           "# TYPE comm0ns_tui_snapshot_rows gauge\n";
+    for (const auto& [table, rows] : report.snapshot_rows) {
+        out << "comm0ns_tui_snapshot_rows{table=\"" << prometheus_label(table) << "\"} " << rows << '\n';
+    }
+    if (report.last_success) {
+        const auto now = std::chrono::system_clock::now();
+        out << "# HELP comm0ns_tui_last_refresh_success_timestamp_seconds When the displayed snapshot was adopted.\n"
+               "# TYPE comm0ns_tui_last_refresh_success_timestamp_seconds gauge\n"
+               "comm0ns_tui_last_refresh_success_timestamp_seconds "
+            << std::chrono::duration<double>(report.last_success->time_since_epoch()).count() << '\n'
+            << "# HELP comm0ns_tui_snapshot_age_seconds Seconds since the displayed snapshot was adopted.\n"
+               "# TYPE comm0ns_tui_snapshot_age_seconds gauge\n"
+               "comm0ns_tui_snapshot_age_seconds "
+            << std::chrono::duration<double>(now - *report.last_success).count() << '\n';
+    }
+
+    prometheus_histogram(out, "comm0ns_tui_frame_duration_seconds", "Wall time of one draw().", report.frame_seconds);
+    out << "# HELP comm0ns_tui_heap_allocations_total Heap allocations made by the process.\n"
+           "# TYPE comm0ns_tui_heap_allocations_total counter\n"
+           "comm0ns_tui_heap_allocations_total " << alloc_totals().count << '\n'
+        << "# HELP process_resident_memory_bytes Resident memory size in bytes.\n"
+           "# TYPE process_resident_memory_bytes gauge\n"
+           "process_resident_memory_bytes " << static_cast<long long>(current_rss_kb()) * 1024 << '\n';
+    return out.str();
+}
+
+// Optional scrape endpoint (--metrics-listen): GET /metrics on its own thread.
+// It only reads perf_stats(), so a scrape never waits on the UI or a refresh.
+class MetricsServer {
+public:
+    MetricsServer() {
+        server_.new_task_queue = [] { return new httplib::ThreadPool(2); };
+        server_.Get("/metrics", [](const httplib::Request&, httplib::Response& res) {
+            res.set_content(prometheus_text(perf_stats().report()), "text/plain; version=0.0.4; charset=utf-8");
+        });
+    }
+    ~MetricsServer() { stop(); }
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    bool start(const std::string& host, int port, std::string& error) {
+        if (!server_.bind_to_port(host, port)) {
+            error = "cannot listen on " + host + ":" + std::to_string(port);
+            return false;
+        }
+        endpoint_ = host + ":" + std::to_string(port);
+        thread_ = std::thread([this]() { server_.listen_after_bind(); });
+        return true;
+    }
+
+    void stop() {
+        if (thread_.joinable()) {
+            server_.stop();
+            thread_.join();
+        }
+    }
+
+    // host:port while serving, empty otherwise.
+    const std::string& endpoint() const { return endpoint_; }
+
+private:
+    httplib::Server server_;
+    std::thread thread_;
+    std::string endpoint_;
+};
+
+// How a QueryField is decoded besides its text: Int and Real columns get a
+// packed numeric array, Day a day serial taken from an ISO date/timestamp.
+enum class FieldType {
+    Text,
+    Int,
+    Real,
+    Day
+};
+
+// One output column of a REST query. Keys are tried in order like jq's `.a // .b`;
+// null/false/missing falls through to `fallback`.
+struct QueryField {
+    std::vector<std::string> keys;
+    std::string fallback;
+    FieldType type = FieldType::Text;
+};
+
+// Columnar query result. All cell text of a response lives in one arena and is
+// handed out as string_view (valid while the result lives); typed columns are
+// decoded once while the response is parsed. Rows are built by set() on the
+// cells present followed by commit_row(), which fills in fallbacks.
+class QueryResult {
+public:
+    static constexpr int kNoDay = std::numeric_limits<int>::min();
+
+    bool ok = false;
+    std::string error;
+
+    QueryResult() = default;
+
+    explicit QueryResult(const std::vector<QueryField>& fields) {
+        columns_.reserve(fields.size());
+        for (const auto& field : fields) {
+            Column column;
+            column.type = field.type;
+            column.fallback = field.fallback;
+            column.fallback_real = parse_double(field.fallback, 0.0);
+            columns_.push_back(std::move(column));
+        }
+        staged_.resize(fields.size());
+    }
+
+    size_t size() const { return rows_; }
+    bool empty() const { return rows_ == 0; }
+
+    std::string_view text(size_t row, size_t col) const {
+        const Column& column = columns_[col];
+        return std::string_view(arena_.data() + column.offset[row], column.length[row]);
+    }
+
+    // Int columns: the leading integer, 0 when unparsable. Day columns: the day
+    // serial or kNoDay.
+    long long integer(size_t row, size_t col) const { return columns_[col].ints[row]; }
+    const std::vector<long long>& integers(size_t col) const { return columns_[col].ints; }
+
+    // Real columns: the number, or the fallback's value when unparsable.
+    double real(size_t row, size_t col) const { return columns_[col].reals[row]; }
+
+    std::optional<int> day(size_t row, size_t col) const {
+        const long long serial = columns_[col].ints[row];
+        return serial == kNoDay ? std::nullopt : std::optional<int>(static_cast<int>(serial));
+    }
+
+    void set(size_t col, std::string_view value) {
+        Staged& cell = staged_[col];
+        cell.offset = static_cast<uint32_t>(arena_.size());
+        cell.length = static_cast<uint32_t>(value.size());
+        cell.present = true;
+        arena_.append(value.data(), value.size());
+    }
+
+    // Same as set() for a jq @tsv field, unescaping straight into the arena.
+    void set_tsv(size_t col, std::string_view value) {
+        Staged& cell = staged_[col];
+        cell.offset = static_cast<uint32_t>(arena_.size());
+        unescape_tsv_field(arena_, value);
+        cell.length = static_cast<uint32_t>(arena_.size() - cell.offset);
+        cell.present = true;
+    }
+
+    void commit_row() {
+        for (size_t col = 0; col < columns_.size(); ++col) {
+            Staged& cell = staged_[col];
+            if (!cell.present) {
+                set(col, columns_[col].fallback);
+            }
+            Column& column = columns_[col];
+            column.offset.push_back(cell.offset);
+            column.length.push_back(cell.length);
+            const std::string_view value(arena_.data() + cell.offset, cell.length);
+            switch (column.type) {
+                case FieldType::Text: break;
+                case FieldType::Int: column.ints.push_back(parse_ll(value, 0)); break;
+                case FieldType::Real: column.reals.push_back(parse_double(value, column.fallback_real)); break;
+                case FieldType::Day: column.ints.push_back(parse_day_serial(value).value_or(kNoDay)); break;
+            }
+            cell.present = false;
+        }
+        ++rows_;
+    }
+
+    void reserve(size_t rows, size_t arena_bytes) {
+        arena_.reserve(arena_bytes);
+        for (auto& column : columns_) {
+            column.offset.reserve(rows);
+            column.length.reserve(rows);
+        }
+    }
+
+    void clear() {
+        arena_.clear();
+        for (auto& column : columns_) {
+            column.offset.clear();
+            column.length.clear();
+            column.ints.clear();
+            column.reals.clear();
+        }
+        rows_ = 0;
+    }
+
+    // Appends the rows of a page built from the same fields.
+    void append(QueryResult&& page) {
+        if (rows_ == 0) {
+            std::string error_text = std::move(error);
+            const bool was_ok = ok;
+            *this = std::move(page);
+            error = std::move(error_text);
+            ok = was_ok;
+            return;
+        }
+        const uint32_t base = static_cast<uint32_t>(arena_.size());
+        arena_.append(page.arena_);
+        for (size_t col = 0; col < columns_.size() && col < page.columns_.size(); ++col) {
+            Column& dst = columns_[col];
+            Column& src = page.columns_[col];
+            for (uint32_t offset : src.offset) {
+                dst.offset.push_back(base + offset);
+            }
+            dst.length.insert(dst.length.end(), src.length.begin(), src.length.end());
+            dst.ints.insert(dst.ints.end(), src.ints.begin(), src.ints.end());
+            dst.reals.insert(dst.reals.end(), src.reals.begin(), src.reals.end());
+        }
+        rows_ += page.rows_;
+    }
+
+private:
+    struct Column {
+        FieldType type = FieldType::Text;
+        std::string fallback;
+        double fallback_real = 0.0;
+        std::vector<uint32_t> offset;
+        std::vector<uint32_t> length;
+        std::vector<long long> ints;
+        std::vector<double> reals;
+    };
+
+    struct Staged {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        bool present = false;
+    };
+
+    std::string arena_;
+    std::vector<Column> columns_;
+    std::vector<Staged> staged_;
+    size_t rows_ = 0;
+};
+
+std::string jq_string_literal(const std::string& value) {
+    std::string out = "\"";
+    for (char ch : value) {
+        if (ch == '"' || ch == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(ch);
+    }
+    out.push_back('"');
+    return out;
+}
+
+std::string jq_program_for(const std::vector<QueryField>& fields) {
+    std::string program = ".[] | [";
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (i) program += ", ";
+        program += "((";
+        for (const auto& key : fields[i].keys) {
+            program += "." + key + " // ";
+        }
+        program += jq_string_literal(fields[i].fallback) + ")|tostring)";
+    }
+    program += "] | @tsv";
+    return program;
+}
+
+// Mirrors `tostring` + `@tsv` + unescape_tsv_field so both fetch paths yield identical rows.
+std::string json_field_text(const nlohmann::json& value) {
+    if (!value.is_string()) {
+        return value.dump();
+    }
+    std::string out = value.get<std::string>();
+    for (char& ch : out) {
+        if (ch == '\n' || ch == '\r' || ch == '\t') {
+            ch = ' ';
+        }
+    }
+    return out;
+}
+
+void project_json_row(QueryResult& out, const nlohmann::json& object, const std::vector<QueryField>& fields) {
+    if (object.is_object()) {
+        for (size_t i = 0; i < fields.size(); ++i) {
+            for (const auto& key : fields[i].keys) {
+                auto it = object.find(key);
+                if (it == object.end() || it->is_null() || (it->is_boolean() && !it->get<bool>())) {
+                    continue;
+                }
+                out.set(i, json_field_text(*it));
+                break;
+            }
+        }
+    }
+    out.commit_row();
+}
+
+// Streams a PostgREST JSON array straight into a QueryResult without building a
+// DOM: only the projected keys are looked at, scalars are written once into the
+// arena. Gives up (returns false from the callback) on a projected key holding
+// an object/array, which the caller then handles through the DOM path.
+class QueryResultSax {
+public:
+    QueryResultSax(QueryResult& out, const std::vector<QueryField>& fields)
+        : out_(out), fields_(fields), priority_(fields.size(), kUnset) {}
+
+    bool nested() const { return nested_; }
+    bool not_array() const { return not_array_; }
+
+    bool null() { return scalar({}, false); }
+    bool boolean(bool value) { return scalar("true", value); }
+    bool number_integer(nlohmann::json::number_integer_t value) { return integral(value); }
+    bool number_unsigned(nlohmann::json::number_unsigned_t value) { return integral(value); }
+    bool number_float(nlohmann::json::number_float_t value, const std::string&) {
+        return scalar(nlohmann::json(value).dump(), true);
+    }
+    bool string(std::string& value) {
+        for (char& ch : value) {
+            if (ch == '\n' || ch == '\r' || ch == '\t') {
+                ch = ' ';
+            }
+        }
+        return scalar(value, true);
+    }
+    bool binary(nlohmann::json::binary_t&) { return scalar({}, false); }
+
+    bool start_object(size_t) { return open(true); }
+    bool start_array(size_t) { return open(false); }
+    bool end_object() { return close(); }
+    bool end_array() { return close(); }
+
+    bool key(std::string& name) {
+        pending_.clear();
+        if (depth_ != 2 || !row_is_object_) {
+            return true;
+        }
+        for (size_t i = 0; i < fields_.size(); ++i) {
+            const auto& keys = fields_[i].keys;
+            for (size_t k = 0; k < keys.size(); ++k) {
+                if (keys[k] == name) {
+                    pending_.push_back({i, k});
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool parse_error(size_t, const std::string&, const nlohmann::detail::exception&) { return false; }
+
+private:
+    static constexpr size_t kUnset = std::numeric_limits<size_t>::max();
+
+    struct Match {
+        size_t field;
+        size_t priority;
+    };
+
+    QueryResult& out_;
+    const std::vector<QueryField>& fields_;
+    std::vector<size_t> priority_;
+    std::vector<Match> pending_;
+    int depth_ = 0;
+    bool row_is_object_ = false;
+    bool nested_ = false;
+    bool not_array_ = false;
+
+    template <typename T>
+    bool integral(T value) {
+        char buf[24];
+        const auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        return scalar(std::string_view(buf, static_cast<size_t>(res.ptr - buf)), true);
+    }
+
+    bool scalar(std::string_view text, bool usable) {
+        if (depth_ == 0) {
+            not_array_ = true;
+            return false;
+        }
+        if (depth_ == 1) {
+            out_.commit_row();
+            return true;
+        }
+        if (depth_ == 2 && usable) {
+            for (const Match& match : pending_) {
+                if (match.priority < priority_[match.field]) {
+                    priority_[match.field] = match.priority;
+                    out_.set(match.field, text);
+                }
+            }
+        }
+        if (depth_ == 2) {
+            pending_.clear();
+        }
+        return true;
+    }
+
+    bool open(bool object) {
+        if (depth_ == 0 && object) {
+            not_array_ = true;
+            return false;
+        }
+        if (depth_ == 1) {
+            row_is_object_ = object;
+            std::fill(priority_.begin(), priority_.end(), kUnset);
+        } else if (depth_ == 2 && !pending_.empty()) {
+            nested_ = true;
+            return false;
+        }
+        ++depth_;
+        return true;
+    }
+
+    bool close() {
+        --depth_;
+        if (depth_ == 1) {
+            out_.commit_row();
+        }
+        pending_.clear();
+        return true;
+    }
+};
+
+// Rows per keyset page; matches Supabase's default PostgREST max-rows cap.
+constexpr size_t kPageSize = 1000;
+
+// Every member past `fields` has a default, so a spec can be brace-built from
+// the first three and the rest assigned.
+struct QuerySpec {
+    std::string endpoint;
+    std::vector<std::string> params;
+    std::vector<QueryField> fields;
+    // Keyset pagination: when cursor_key is set, rows are requested kPageSize at
+    // a time ordered by cursor_key ascending, each page resuming after the last
+    // row's cursor_field value (`gt.`, or `gte.` with cursor_inclusive for keys
+    // that can repeat; the consumer drops the re-sent boundary rows).
+    std::string cursor_key = {};
+    size_t cursor_field = 0;
+    std::string cursor_start = {};
+    bool cursor_inclusive = false;
+    // Unique column breaking ties of a repeating cursor_key: pages then order by
+    // both and resume after the last row's pair, so a page of rows sharing one
+    // key still moves on. Only the first page (from cursor_start) is inclusive.
+    std::string tiebreak_key = {};
+    size_t tiebreak_field = 0;
+    // When set, each page is handed over as it arrives instead of accumulating in
+    // the result, so memory stays at one page whatever the table size.
+    std::function<void(const QueryResult&)> on_page = {};
+    // Called on the fetching thread once the slot finishes, successful or not.
+    std::function<void(const QueryResult&)> on_done = {};
+    // Keep each response and revalidate it (If-None-Match / If-Modified-Since)
+    // next time; an unchanged one returns the kept result without parsing.
+    // Not for on_page specs, whose pages are not kept.
+    bool revalidate = false;
+    // When set the slot is not requested at all: its result is a copy of this
+    // (a table still inside its refresh interval).
+    const QueryResult* reuse = nullptr;
+};
+
+// PostgREST access for $SUPABASE_URL/rest/v1/. Requests go over one persistent
+// keep-alive connection; the bash/curl/jq pipeline is only used when the native
+// client cannot be built (e.g. https without OpenSSL), when forced with
+// COMM0NS_TUI_FETCH=shell, or as a one-shot retry after a transport failure.
+class SupabaseClient {
+public:
+    // One request; its latency, size and row count go to perf_stats().
+    QueryResult query(
+        const std::string& endpoint,
+        const std::vector<std::string>& query_params,
+        const std::vector<QueryField>& fields,
+        bool revalidate = false
+    ) {
+        const PerfClock::time_point start = PerfClock::now();
+        received_bytes_ = 0;
+        unchanged_ = false;
+        QueryResult out = query_once(endpoint, query_params, fields, revalidate);
+        perf_stats().record_query(endpoint, elapsed_us(start), received_bytes_, out.size(), out.ok, unchanged_);
+        return out;
+    }
+
+    QueryResult run(const QuerySpec& spec) {
+        const bool revalidate = spec.revalidate && !spec.on_page;
+        if (spec.cursor_key.empty()) {
+            QueryResult out = query(spec.endpoint, spec.params, spec.fields, revalidate);
+            if (out.ok && spec.on_page) {
+                spec.on_page(out);
+                out.clear();
+            }
+            return out;
+        }
+
+        QueryResult out(spec.fields);
+        out.ok = true;
+        const bool tiebreak = !spec.tiebreak_key.empty() && spec.tiebreak_field < spec.fields.size();
+        std::string cursor = spec.cursor_start;
+        std::string cursor_tiebreak;  // the last row's tiebreak_field, past the first page
+        for (;;) {
+            std::vector<std::string> params = spec.params;
+            if (!cursor_tiebreak.empty()) {
+                // (key, tiebreak) > (cursor, cursor_tiebreak); values are quoted, as
+                // timestamps hold PostgREST's reserved `.` and `:`.
+                const std::string key = '"' + cursor + '"';
+                const std::string tie = '"' + cursor_tiebreak + '"';
+                params.push_back("or=(" + spec.cursor_key + ".gt." + key + ",and(" + spec.cursor_key + ".eq." + key + "," +
+                                 spec.tiebreak_key + ".gt." + tie + "))");
+            } else if (!cursor.empty()) {
+                params.push_back(spec.cursor_key + (spec.cursor_inclusive ? "=gte." : "=gt.") + cursor);
+            }
+            params.push_back("order=" + spec.cursor_key + ".asc" + (tiebreak ? "," + spec.tiebreak_key + ".asc" : ""));
+            params.push_back("limit=" + std::to_string(kPageSize));
+
+            QueryResult page = query(spec.endpoint, params, spec.fields, revalidate);
+            if (!page.ok) {
+                out.ok = false;
+                out.error = page.error;
+                out.clear();
+                return out;
+            }
+
+            const size_t count = page.size();
+            const std::string next = count && spec.cursor_field < spec.fields.size()
+                ? std::string(page.text(count - 1, spec.cursor_field))
+                : std::string();
+            const std::string next_tiebreak = count && tiebreak ? std::string(page.text(count - 1, spec.tiebreak_field)) : std::string();
+            if (spec.on_page) {
+                spec.on_page(page);
+            } else {
+                out.append(std::move(page));
+            }
+            // A short page ends the table.
+            if (count < kPageSize || next.empty() || (tiebreak && next_tiebreak.empty())) {
+                return out;
+            }
+            // kPageSize rows on one key of an inclusive cursor without a tiebreak:
+            // the table cannot be walked from here, so fail rather than stop short.
+            if (!tiebreak && next == cursor) {
+                out.ok = false;
+                out.error = spec.endpoint + ": " + std::to_string(kPageSize) + " rows share " + spec.cursor_key + "=" + cursor;
+                out.clear();
+                return out;
+            }
+            cursor = next;
+            cursor_tiebreak = next_tiebreak;
+        }
+    }
+
+    // Safe from any thread: aborts the in-flight request and fails later ones fast.
+    void cancel() {
+        cancelled_ = true;
+        std::lock_guard<std::mutex> lock(http_mutex_);
+        if (http_) {
+            http_->stop();
+        }
+    }
+
+private:
+    std::string base_url_;
+    std::unique_ptr<httplib::Client> http_;
+    std::mutex http_mutex_;  // guards the http_ pointer against cancel()
+    bool native_disabled_ = false;
+    std::atomic<bool> cancelled_{false};
+    size_t received_bytes_ = 0;  // response bytes of the current query()
+    bool unchanged_ = false;     // the current query() was a response cache hit
+
+    // The last response per request (endpoint + params) of revalidate specs.
+    // Slot i of the fetch pool always runs on this client, so it sees the same
+    // requests every refresh; keys that stop recurring (keyset cursors of a
+    // growing table) are dropped wholesale at the cap.
+    struct CachedResponse {
+        std::string etag;
+        std::string last_modified;
+        size_t body_hash = 0;
+        size_t body_size = 0;
+        QueryResult result;
+    };
+    static constexpr size_t kMaxCachedResponses = 64;
+    std::unordered_map<std::string, CachedResponse> responses_;
+
+    // Native first; the shell pipeline when it is unavailable or fails to connect.
+    QueryResult query_once(
+        const std::string& endpoint,
+        const std::vector<std::string>& query_params,
+        const std::vector<QueryField>& fields,
+        bool revalidate
+    ) {
+        if (cancelled_) {
+            QueryResult out(fields);
+            out.error = "cancelled";
+            return out;
+        }
+        if (!ensure_native()) {
+            return query_shell(endpoint, query_params, fields);
+        }
+
+        std::string transport_error;
+        QueryResult out = query_native(endpoint, query_params, fields, revalidate, transport_error);
+        if (transport_error.empty() || cancelled_) {
+            if (!transport_error.empty()) {
+                out.error = "cancelled";
+            }
+            return out;
+        }
+
+        QueryResult shell = query_shell(endpoint, query_params, fields);
+        if (shell.ok) {
+            // curl reached the server where httplib could not (CA store, proxy...):
+            // stop paying for the failing native attempt on every query.
+            native_disabled_ = true;
+            return shell;
+        }
+        shell.error = "native: " + transport_error + " / shell: " + shell.error;
+        return shell;
+    }
+
+    bool ensure_native() {
+        if (native_disabled_ || env_or_empty("COMM0NS_TUI_FETCH") == "shell") {
+            return false;
+        }
+        std::string url = env_or_empty("SUPABASE_URL");
+        const std::string key = env_or_empty("SUPABASE_KEY");
+        while (!url.empty() && url.back() == '/') {
+            url.pop_back();
+        }
+        if (url.empty() || key.empty()) {
+            return false;
+        }
+        if (http_ && url == base_url_) {
+            return true;
+        }
+
+        base_url_ = url;
+        auto client = std::make_unique<httplib::Client>(url);
+        if (!client->is_valid()) {
+            std::lock_guard<std::mutex> lock(http_mutex_);
+            http_.reset();
+            native_disabled_ = true;
+            return false;
+        }
+        std::string token = env_or_empty("SUPABASE_AUTH_TOKEN");
+        if (token.empty()) {
+            token = key;
+        }
+        client->set_keep_alive(true);
+        client->set_connection_timeout(10);
+        client->set_read_timeout(30);
+        client->set_default_headers({
+            {"apikey", key},
+            {"Authorization", "Bearer " + token},
+            {"Accept", "application/json"}
+        });
+        std::lock_guard<std::mutex> lock(http_mutex_);
+        http_ = std::move(client);
+        responses_.clear();
+        return true;
+    }
+
+    // Accept-Encoding (gzip / br) is added by httplib when built with zlib or
+    // brotli, and the body arrives decoded.
+    QueryResult query_native(
+        const std::string& endpoint,
+        const std::vector<std::string>& query_params,
+        const std::vector<QueryField>& fields,
+        bool revalidate,
+        std::string& transport_error
+    ) {
+        QueryResult out(fields);
+        std::string cache_key;
+        CachedResponse* cached = nullptr;
+        httplib::Headers headers;
+        if (revalidate) {
+            cache_key = endpoint;
+            for (const auto& param : query_params) {
+                cache_key += '&';
+                cache_key += param;
+            }
+            const auto it = responses_.find(cache_key);
+            if (it != responses_.end()) {
+                cached = &it->second;
+                if (!cached->etag.empty()) {
+                    headers.emplace("If-None-Match", cached->etag);
+                }
+                if (!cached->last_modified.empty()) {
+                    headers.emplace("If-Modified-Since", cached->last_modified);
+                }
+            }
+        }
+
+        httplib::Params params;
+        for (const auto& param : query_params) {
+            const size_t eq = param.find('=');
+            if (eq == std::string::npos) {
+                params.emplace(param, "");
+            } else {
+                params.emplace(param.substr(0, eq), param.substr(eq + 1));
+            }
+        }
+
+        const httplib::Result res = http_->Get("/rest/v1/" + endpoint, params, headers);
+        if (!res) {
+            transport_error = httplib::to_string(res.error());
+            return out;
+        }
+        if (cached && res->status == 304) {
+            unchanged_ = true;
+            return cached->result;
+        }
+        if (res->status < 200 || res->status >= 300) {
+            out.error = "HTTP " + std::to_string(res->status) + ": " + fit(res->body, 200);
+            return out;
+        }
+
+        received_bytes_ += res->body.size();
+        // PostgREST only sends validators when something in front of it adds
+        // them; comparing the body still saves the parse for an unchanged table.
+        const size_t body_hash = revalidate ? std::hash<std::string_view>{}(res->body) : 0;
+        if (cached && cached->body_size == res->body.size() && cached->body_hash == body_hash) {
+            unchanged_ = true;
+            cached->etag = res->get_header_value("ETag");
+            cached->last_modified = res->get_header_value("Last-Modified");
+            return cached->result;
+        }
+
+        out = parse_body(res->body, fields);
+        if (revalidate && out.ok) {
+            if (!cached && responses_.size() >= kMaxCachedResponses) {
+                responses_.clear();
+            }
+            CachedResponse& entry = responses_[cache_key];
+            entry.etag = res->get_header_value("ETag");
+            entry.last_modified = res->get_header_value("Last-Modified");
+            entry.body_hash = body_hash;
+            entry.body_size = res->body.size();
+            entry.result = out;
+        }
+        return out;
+    }
+
+    static QueryResult parse_body(const std::string& text, const std::vector<QueryField>& fields) {
+        ScopedPerfTimer parse_timer(PerfStage::Parse, true);
+        QueryResult out(fields);
+        // The arena never outgrows the body it was projected from.
+        out.reserve(0, text.size());
+        QueryResultSax sax(out, fields);
+        if (nlohmann::json::sax_parse(text, &sax)) {
+            out.ok = true;
+            return out;
+        }
+
+        out = QueryResult(fields);
+        const nlohmann::json body = sax.nested() ? nlohmann::json::parse(text, nullptr, false) : nlohmann::json();
+        if (body.is_discarded() || !body.is_array()) {
+            out.error = "unexpected response body: " + fit(text, 200);
+            return out;
+        }
+
+        out.ok = true;
+        for (const auto& object : body) {
+            project_json_row(out, object, fields);
+        }
+        return out;
+    }
+
+    QueryResult query_shell(
+        const std::string& endpoint,
+        const std::vector<std::string>& query_params,
+        const std::vector<QueryField>& fields
+    ) {
+        QueryResult out(fields);
+        std::string script = "set -o pipefail; "
+                             "if [ -z \"$SUPABASE_URL\" ] || [ -z \"$SUPABASE_KEY\" ]; then "
+                             "echo \"SUPABASE_URL/SUPABASE_KEY missing\"; exit 64; fi; "
+                             "AUTH_TOKEN=\"${SUPABASE_AUTH_TOKEN:-$SUPABASE_KEY}\"; "
+                             "curl -sS --fail --compressed --get \"$SUPABASE_URL/rest/v1/" + endpoint + "\" "
+                             "-H \"apikey: $SUPABASE_KEY\" "
+                             "-H \"Authorization: Bearer $AUTH_TOKEN\" "
+                             "2>/dev/null ";
+        for (const auto& param : query_params) {
+            script += "--data-urlencode " + shell_quote(param) + " ";
+        }
+        script += "| jq -r " + shell_quote(jq_program_for(fields));
+
+        const ShellResult shell = run_shell("bash -lc " + shell_quote(script));
+        if (shell.exit_code != 0) {
+            out.error = shell.output.empty() ? "query failed" : shell.output;
+            return out;
+        }
+
+        received_bytes_ += shell.output.size();
+        ScopedPerfTimer parse_timer(PerfStage::Parse, true);
+        out.ok = true;
+        out.reserve(shell.lines.size(), shell.output.size());
+        for (const std::string& line : shell.lines) {
+            const std::string_view view(line);
+            size_t col = 0;
+            size_t begin = 0;
+            for (;;) {
+                const size_t tab = view.find('\t', begin);
+                if (col < fields.size()) {
+                    out.set_tsv(col, view.substr(begin, tab == std::string_view::npos ? std::string_view::npos : tab - begin));
+                }
+                ++col;
+                if (tab == std::string_view::npos) {
+                    break;
+                }
+                begin = tab + 1;
+            }
+            out.commit_row();
+        }
+        return out;
+    }
+};
+
+// Runs a batch of queries concurrently. Slot i always uses client i and, past
+// slot 0 (which runs on the caller), the worker kept for it, so each endpoint
+// of a recurring batch keeps its own warm keep-alive connection and a poll
+// starts no threads.
+class SupabaseFetchPool {
+public:
+    SupabaseFetchPool() = default;
+    SupabaseFetchPool(const SupabaseFetchPool&) = delete;
+    SupabaseFetchPool& operator=(const SupabaseFetchPool&) = delete;
+
+    ~SupabaseFetchPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& slot : slots_) {
+            if (slot->worker.joinable()) {
+                slot->worker.join();
+            }
+        }
+    }
+
+    std::vector<QueryResult> fetch_all(const std::vector<QuerySpec>& specs) {
+        std::vector<QueryResult> results(specs.size());
+        if (specs.empty()) {
+            return results;
+        }
+        const std::function<void(size_t)> run_slot = [&](size_t i) {
+            results[i] = specs[i].reuse ? *specs[i].reuse : slots_[i]->client->run(specs[i]);
+            if (specs[i].on_done) {
+                specs[i].on_done(results[i]);
+            }
+        };
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            grow(specs.size());
+            job_ = &run_slot;
+            for (size_t i = 1; i < specs.size(); ++i) {
+                slots_[i]->pending = true;
+            }
+            busy_ = specs.size() - 1;
+        }
+        wake_.notify_all();
+        run_slot(0);
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return busy_ == 0; });
+        job_ = nullptr;
+        return results;
+    }
+
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+        for (auto& slot : slots_) {
+            slot->client->cancel();
+        }
+    }
+
+private:
+    struct Slot {
+        std::unique_ptr<SupabaseClient> client = std::make_unique<SupabaseClient>();
+        std::thread worker;  // none for slot 0
+        bool pending = false;
+    };
+
+    // Guards slots_ growth against cancel() and hands batches to the workers.
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    const std::function<void(size_t)>* job_ = nullptr;  // the running batch
+    size_t busy_ = 0;
+    bool cancelled_ = false;
+    bool stop_ = false;
+
+    void grow(size_t count) {
+        while (slots_.size() < count) {
+            const size_t index = slots_.size();
+            slots_.push_back(std::make_unique<Slot>());
+            if (cancelled_) {
+                slots_.back()->client->cancel();
+            }
+            if (index > 0) {
+                slots_.back()->worker = std::thread([this, index]() { serve(index); });
+            }
+        }
+    }
+
+    void serve(size_t index) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Slot& slot = *slots_[index];
+        for (;;) {
+            wake_.wait(lock, [&]() { return stop_ || slot.pending; });
+            if (stop_) {
+                return;
+            }
+            slot.pending = false;
+            const std::function<void(size_t)>& job = *job_;
+            lock.unlock();
+            job(index);
+            lock.lock();
+            if (--busy_ == 0) {
+                done_.notify_all();
+            }
+        }
+    }
+};
+
+// Host-order binary encoding for the on-disk snapshot cache. The reader is
+// bounds-checked and sticky: after the first short read every value decodes as
+// zero/empty and ok() turns false, so callers validate once at the end.
+class BinaryWriter {
+public:
+    void u8(uint8_t v) { raw(&v, sizeof(v)); }
+    void u32(uint32_t v) { raw(&v, sizeof(v)); }
+    void i32(int32_t v) { raw(&v, sizeof(v)); }
+    void i64(int64_t v) { raw(&v, sizeof(v)); }
+    void u64(uint64_t v) { raw(&v, sizeof(v)); }
+    void f64(double v) { raw(&v, sizeof(v)); }
+    void boolean(bool v) { u8(v ? 1 : 0); }
+    void str(const std::string& v) {
+        u32(static_cast<uint32_t>(v.size()));
+        buf_.append(v);
+    }
+    const std::string& data() const { return buf_; }
+
+private:
+    std::string buf_;
+
+    void raw(const void* p, size_t n) { buf_.append(static_cast<const char*>(p), n); }
+};
+
+class BinaryReader {
+public:
+    BinaryReader(const char* data, size_t size) : cur_(data), end_(data + size) {}
+
+    uint8_t u8() { return pod<uint8_t>(); }
+    uint32_t u32() { return pod<uint32_t>(); }
+    int32_t i32() { return pod<int32_t>(); }
+    int64_t i64() { return pod<int64_t>(); }
+    uint64_t u64() { return pod<uint64_t>(); }
+    double f64() { return pod<double>(); }
+    bool boolean() { return u8() != 0; }
+    std::string str() {
+        const uint32_t n = u32();
+        if (!take(n)) {
+            return {};
+        }
+        return std::string(cur_ - n, n);
+    }
+    // Element counts are capped by the bytes left so a corrupt file cannot make
+    // us reserve gigabytes.
+    uint32_t count() {
+        const uint32_t n = u32();
+        if (n > static_cast<size_t>(end_ - cur_)) {
+            ok_ = false;
+            return 0;
+        }
+        return n;
+    }
+    bool ok() const { return ok_; }
+
+private:
+    const char* cur_;
+    const char* end_;
+    bool ok_ = true;
+
+    bool take(size_t n) {
+        if (!ok_ || static_cast<size_t>(end_ - cur_) < n) {
+            ok_ = false;
+            return false;
+        }
+        cur_ += n;
+        return true;
+    }
+
+    template <typename T>
+    T pod() {
+        T v{};
+        if (take(sizeof(T))) {
+            std::memcpy(&v, cur_ - sizeof(T), sizeof(T));
+        }
+        return v;
+    }
+};
+
+void encode(BinaryWriter& w, const std::string& v) { w.str(v); }
+void decode(BinaryReader& r, std::string& v) { v = r.str(); }
+void encode(BinaryWriter& w, int v) { w.i32(v); }
+void decode(BinaryReader& r, int& v) { v = r.i32(); }
+
+template <typename T>
+void encode(BinaryWriter& w, const std::vector<T>& items) {
+    w.u32(static_cast<uint32_t>(items.size()));
+    for (const auto& item : items) {
+        encode(w, item);
+    }
+}
+
+template <typename T>
+void decode(BinaryReader& r, std::vector<T>& items) {
+    items.clear();
+    const uint32_t n = r.count();
+    items.resize(n);
+    for (auto& item : items) {
+        decode(r, item);
+    }
+}
+
+void encode(BinaryWriter& w, const Member& m) {
+    w.i64(m.user_id);
+    w.str(m.name);
+    for (int v : {m.cp, m.ts, m.streak, m.info, m.insight, m.vibe, m.ops, m.misc, m.votes_participated, m.active_week, m.active_month}) {
+        w.i32(v);
+    }
+    w.boolean(m.online);
+    encode(w, m.titles);
+}
+
+void decode(BinaryReader& r, Member& m) {
+    m.user_id = r.i64();
+    m.name = r.str();
+    for (int* v : {&m.cp, &m.ts, &m.streak, &m.info, &m.insight, &m.vibe, &m.ops, &m.misc, &m.votes_participated, &m.active_week, &m.active_month}) {
+        *v = r.i32();
+    }
+    m.online = r.boolean();
+    decode(r, m.titles);
+}
+
+void encode(BinaryWriter& w, const Channel& c) {
+    w.str(c.name);
+    w.i32(c.messages_total);
+    w.i32(c.messages_month);
+    w.i32(c.messages_week);
+    w.str(c.champion);
+    w.i32(c.active_users);
+    w.f64(c.weight);
+}
+
+void decode(BinaryReader& r, Channel& c) {
+    c.name = r.str();
+    c.messages_total = r.i32();
+    c.messages_month = r.i32();
+    c.messages_week = r.i32();
+    c.champion = r.str();
+    c.active_users = r.i32();
+    c.weight = r.f64();
+}
+
+void encode(BinaryWriter& w, const Vote& v) {
+    w.str(v.id);
+    w.str(v.title);
+    w.str(v.type);
+    for (int n : {v.yes_vp, v.no_vp, v.voters, v.total_eligible, v.days_left}) {
+        w.i32(n);
+    }
+}
+
+void decode(BinaryReader& r, Vote& v) {
+    v.id = r.str();
+    v.title = r.str();
+    v.type = r.str();
+    for (int* n : {&v.yes_vp, &v.no_vp, &v.voters, &v.total_eligible, &v.days_left}) {
+        *n = r.i32();
+    }
+}
+
+void encode(BinaryWriter& w, const Issue& i) {
+    w.i32(i.id);
+    for (const std::string* f : {&i.title, &i.label, &i.priority, &i.status, &i.assignee}) {
+        w.str(*f);
+    }
+}
+
+void decode(BinaryReader& r, Issue& i) {
+    i.id = r.i32();
+    for (std::string* f : {&i.title, &i.label, &i.priority, &i.status, &i.assignee}) {
+        *f = r.str();
+    }
+}
+
+void encode(BinaryWriter& w, const FeedItem& f) {
+    w.str(f.type);
+    w.str(f.user);
+    w.str(f.message);
+}
+
+void decode(BinaryReader& r, FeedItem& f) {
+    f.type = r.str();
+    f.user = r.str();
+    f.message = r.str();
+}
+
+// 0-100, or 255 for none.
+void encode_stage2_percent(BinaryWriter& w, int percent) {
+    w.u8(percent < 0 ? 255 : static_cast<uint8_t>(std::min(percent, 100)));
+}
+
+int decode_stage2_percent(BinaryReader& r) {
+    const uint8_t v = r.u8();
+    return v > 100 ? -1 : v;
+}
+
+void encode(BinaryWriter& w, const MessageSample& m) {
+    w.str(m.channel);
+    w.str(m.text);
+    w.u8(static_cast<uint8_t>(m.category));
+    encode_stage2_percent(w, m.stage2_percent);
+}
+
+void decode(BinaryReader& r, MessageSample& m) {
+    m.channel = r.str();
+    m.text = r.str();
+    m.category = static_cast<Category>(std::min<uint8_t>(r.u8(), static_cast<uint8_t>(Category::Misc)));
+    m.stage2_percent = decode_stage2_percent(r);
+}
+
+void encode(BinaryWriter& w, const Sprint& s) {
+    w.str(s.name);
+    w.str(s.start_date);
+    w.str(s.end_date);
+    encode(w, s.issue_ids);
+    w.i32(s.bonus_cp);
+}
+
+void decode(BinaryReader& r, Sprint& s) {
+    s.name = r.str();
+    s.start_date = r.str();
+    s.end_date = r.str();
+    decode(r, s.issue_ids);
+    s.bonus_cp = r.i32();
+}
+
+void encode(BinaryWriter& w, const ScoringBasis& b) {
+    encode(w, b.channels);
+    for (double weight : b.weights) {
+        w.f64(weight);
+    }
+    w.u32(static_cast<uint32_t>(b.member_count));
+    encode(w, b.base_cp);
+}
+
+void decode(BinaryReader& r, ScoringBasis& b) {
+    decode(r, b.channels);
+    b.weights.resize(b.channels.size());
+    for (double& weight : b.weights) {
+        weight = r.f64();
+    }
+    b.member_count = r.u32();
+    decode(r, b.base_cp);
+    if (b.base_cp.size() != b.channels.size() * b.member_count) {
+        b = ScoringBasis();
+    }
+}
+
+// Open-addressing table keyed by a non-zero 64-bit key. Aggregation folds one
+// row per message, so lookups must not chase list nodes or allocate.
+template <typename Value>
+class FlatTable {
+public:
+    struct Slot {
+        uint64_t key = 0;
+        Value value{};
+    };
+
+    // Value for `key`, default-constructed on first use; `inserted` tells which.
+    Value& get(uint64_t key, bool& inserted) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            grow();
+        }
+        Slot& slot = slots_[probe(key)];
+        inserted = slot.key == 0;
+        if (inserted) {
+            slot.key = key;
+            ++size_;
+        }
+        return slot.value;
+    }
+
+    const Value* find(uint64_t key) const {
+        if (slots_.empty()) {
+            return nullptr;
+        }
+        const Slot& slot = slots_[probe(key)];
+        return slot.key == 0 ? nullptr : &slot.value;
+    }
+
+    Value* find(uint64_t key) {
+        return const_cast<Value*>(static_cast<const FlatTable&>(*this).find(key));
+    }
+
+    size_t size() const { return size_; }
+
+    template <typename Fn>
+    void for_each(Fn fn) const {
+        for (const Slot& slot : slots_) {
+            if (slot.key != 0) {
+                fn(slot.key, slot.value);
+            }
+        }
+    }
+
+private:
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+
+    size_t probe(uint64_t key) const {
+        const size_t mask = slots_.size() - 1;
+        uint64_t h = key ^ (key >> 33);
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        size_t i = static_cast<size_t>(h) & mask;
+        while (slots_[i].key != 0 && slots_[i].key != key) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow() {
+        std::vector<Slot> old(std::max<size_t>(16, slots_.size() * 2));
+        old.swap(slots_);
+        for (const Slot& slot : old) {
+            if (slot.key != 0) {
+                slots_[probe(slot.key)] = slot;
+            }
+        }
+    }
+};
+
+// Scratch memory for one snapshot build: a monotonic arena over a buffer kept
+// between builds and released in one go when the build returns. What spills
+// past the buffer grows it for the next build, so once it has seen the largest
+// refresh, the temporaries of a rebuild cost no heap allocations at all.
+class ScratchArena {
+public:
+    static constexpr size_t kInitialBytes = size_t{64} << 10;
+    static constexpr size_t kMaxBytes = size_t{64} << 20;
+
+    class Scope {
+    public:
+        explicit Scope(ScratchArena& arena)
+            : arena_(arena), resource_(arena.buffer_.get(), arena.size_, &spill_) {}
+        ~Scope() {
+            resource_.release();
+            arena_.grow(spill_.bytes);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        std::pmr::memory_resource* resource() { return &resource_; }
+
+    private:
+        // Heap fallback that remembers how much it handed out.
+        struct Spill : std::pmr::memory_resource {
+            size_t bytes = 0;
+            void* do_allocate(size_t n, size_t align) override {
+                bytes += n;
+                return std::pmr::new_delete_resource()->allocate(n, align);
+            }
+            void do_deallocate(void* p, size_t n, size_t align) override {
+                std::pmr::new_delete_resource()->deallocate(p, n, align);
+            }
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+        };
+
+        ScratchArena& arena_;
+        Spill spill_;
+        std::pmr::monotonic_buffer_resource resource_;
+    };
+
+    ScratchArena() : buffer_(new std::byte[kInitialBytes]), size_(kInitialBytes) {}
+
+    size_t capacity() const { return size_; }
+
+private:
+    std::unique_ptr<std::byte[]> buffer_;
+    size_t size_;
+
+    void grow(size_t spilled) {
+        if (spilled == 0 || size_ >= kMaxBytes) {
+            return;
+        }
+        size_ = std::min(kMaxBytes, size_ + spilled);
+        buffer_.reset(new std::byte[size_]);
+    }
+};
+
+// Discord snowflakes interned to dense indices in first-seen order, so
+// per-user and per-channel aggregates can live in plain arrays. Id 0 is
+// FlatTable's empty-slot key, so it never enters the table and gets its own
+// index instead (a missing column parses as 0).
+class IdIndex {
+public:
+    uint32_t intern(long long id) {
+        if (id == 0) {
+            if (!zero_) {
+                zero_ = static_cast<uint32_t>(ids_.size());
+                ids_.push_back(0);
+            }
+            return *zero_;
+        }
+        bool inserted = false;
+        uint32_t& index = table_.get(static_cast<uint64_t>(id), inserted);
+        if (inserted) {
+            index = static_cast<uint32_t>(ids_.size());
+            ids_.push_back(id);
+        }
+        return index;
+    }
+
+    std::optional<uint32_t> find(long long id) const {
+        if (id == 0) {
+            return zero_;
+        }
+        const uint32_t* index = table_.find(static_cast<uint64_t>(id));
+        return index ? std::optional<uint32_t>(*index) : std::nullopt;
+    }
+
+    long long id(uint32_t index) const { return ids_[index]; }
+    size_t size() const { return ids_.size(); }
+
+private:
+    FlatTable<uint32_t> table_;
+    std::vector<long long> ids_;
+    std::optional<uint32_t> zero_;
+};
+
+// Per-day counts as a day-sorted vector. Rows mostly arrive in time order, so
+// adding is nearly always a bump or an append at the back.
+class DayCounts {
+public:
+    void add(int day, int n = 1) {
+        if (days_.empty() || days_.back().first < day) {
+            days_.push_back({day, n});
+            return;
+        }
+        if (days_.back().first == day) {
+            days_.back().second += n;
+            return;
+        }
+        auto it = std::lower_bound(days_.begin(), days_.end(), std::make_pair(day, std::numeric_limits<int>::min()));
+        if (it != days_.end() && it->first == day) {
+            it->second += n;
+        } else {
+            days_.insert(it, {day, n});
+        }
+    }
+
+    int at(int day) const {
+        auto it = std::lower_bound(days_.begin(), days_.end(), std::make_pair(day, std::numeric_limits<int>::min()));
+        return it != days_.end() && it->first == day ? it->second : 0;
+    }
+
+    int since(int first_day) const {
+        int count = 0;
+        for (auto it = days_.rbegin(); it != days_.rend() && it->first >= first_day; ++it) {
+            count += it->second;
+        }
+        return count;
+    }
+
+    const std::vector<std::pair<int, int>>& entries() const { return days_; }
+
+private:
+    std::vector<std::pair<int, int>> days_;
+};
+
+void encode(BinaryWriter& w, const DayCounts& daily) {
+    w.u32(static_cast<uint32_t>(daily.entries().size()));
+    for (const auto& kv : daily.entries()) {
+        w.i32(kv.first);
+        w.i32(kv.second);
+    }
+}
+
+void decode(BinaryReader& r, DayCounts& daily) {
+    daily = DayCounts();
+    const uint32_t n = r.count();
+    for (uint32_t i = 0; i < n; ++i) {
+        const int day = r.i32();
+        daily.add(day, r.i32());
+    }
+}
+
+// The most recent kDays days of activity, one bit per day: bit k of the window
+// is day `newest - k`. Setting a newer day slides the window forward; days that
+// fall off the far end are dropped (streaks and 7/30-day windows never reach
+// them).
+class DayBitmap {
+public:
+    static constexpr int kWords = 8;
+    static constexpr int kDays = kWords * 64;
+
+    void set(int day) {
+        if (empty_) {
+            empty_ = false;
+            newest_ = day;
+        } else if (day > newest_) {
+            slide(day - newest_);
+            newest_ = day;
+        }
+        const int k = newest_ - day;
+        if (k < kDays) {
+            words_[k / 64] |= uint64_t{1} << (k % 64);
+        }
+    }
+
+    bool test(int day) const {
+        if (empty_ || day > newest_ || newest_ - day >= kDays) {
+            return false;
+        }
+        const int k = newest_ - day;
+        return (words_[k / 64] >> (k % 64)) & 1;
+    }
+
+    // Consecutive active days ending at `day`; 0 when `day` itself is inactive.
+    int run_ending(int day) const {
+        if (empty_ || day > newest_) {
+            return 0;
+        }
+        int run = 0;
+        for (int k = newest_ - day; k < kDays;) {
+            const int shift = k % 64;
+            // Inverted, the active days become a run of trailing zeros; the
+            // shifted-in top bits turn into ones and cap the run at the word end.
+            const uint64_t gaps = ~(words_[k / 64] >> shift);
+            const int ones = gaps == 0 ? 64 : __builtin_ctzll(gaps);
+            run += ones;
+            if (ones < 64 - shift) {
+                break;
+            }
+            k += ones;
+        }
+        return run;
+    }
+
+    // Active days in [first_day, last_day].
+    int count(int first_day, int last_day) const {
+        if (empty_ || first_day > last_day || first_day > newest_) {
+            return 0;
+        }
+        const int lo = std::max(0, newest_ - std::min(last_day, newest_));
+        const int hi = std::min(kDays - 1, newest_ - first_day);
+        int total = 0;
+        for (int word = lo / 64; word <= hi / 64; ++word) {
+            uint64_t bits = words_[word];
+            const int from = std::max(lo - word * 64, 0);
+            const int to = std::min(hi - word * 64, 63);
+            bits >>= from;
+            if (to - from < 63) {
+                bits &= (uint64_t{1} << (to - from + 1)) - 1;
+            }
+            total += __builtin_popcountll(bits);
+        }
+        return total;
+    }
+
+    bool empty() const { return empty_; }
+    int newest() const { return newest_; }
+    const std::array<uint64_t, kWords>& words() const { return words_; }
+
+    void restore(int newest, const std::array<uint64_t, kWords>& words) {
+        empty_ = false;
+        newest_ = newest;
+        words_ = words;
+    }
+
+private:
+    bool empty_ = true;
+    int newest_ = 0;
+    std::array<uint64_t, kWords> words_{};
+
+    // Moves every bit `days` positions toward the old end.
+    void slide(int days) {
+        if (days >= kDays) {
+            words_.fill(0);
+            return;
+        }
+        const int words = days / 64;
+        const int bits = days % 64;
+        for (int i = kWords - 1; i >= 0; --i) {
+            const int src = i - words;
+            uint64_t v = 0;
+            if (src >= 0) {
+                v = words_[src] << bits;
+                if (bits != 0 && src > 0) {
+                    v |= words_[src - 1] >> (64 - bits);
+                }
+            }
+            words_[i] = v;
+        }
+    }
+};
+
+void encode(BinaryWriter& w, const DayBitmap& days) {
+    w.boolean(!days.empty());
+    if (!days.empty()) {
+        w.i32(days.newest());
+        for (uint64_t word : days.words()) {
+            w.u64(word);
+        }
+    }
+}
+
+void decode(BinaryReader& r, DayBitmap& days) {
+    days = DayBitmap();
+    if (r.boolean()) {
+        const int newest = r.i32();
+        std::array<uint64_t, DayBitmap::kWords> words{};
+        for (uint64_t& word : words) {
+            word = r.u64();
+        }
+        days.restore(newest, words);
+    }
+}
+
+// Message counts per category in fixed rings of minute, hour and day buckets.
+// Every row lands in all three rings, so recent activity is kept at minute
+// detail and, as it ages out of each ring, survives only at the coarser
+// resolutions. Memory stays constant however much history is folded in.
+class ActivitySeries {
+public:
+    enum Resolution : size_t { kMinutes, kHours, kDays, kResolutionCount };
+
+    static constexpr std::array<int, kResolutionCount> kBuckets = {120, 48, 60};
+    static constexpr std::array<int, kResolutionCount> kBucketMinutes = {1, 60, 1440};
+
+    ActivitySeries() {
+        for (size_t r = 0; r < kResolutionCount; ++r) {
+            rings_[r].slots.assign(static_cast<size_t>(kBuckets[r]), {});
+        }
+    }
+
+    void add(long long epoch_minute, Category category) {
+        for (size_t r = 0; r < kResolutionCount; ++r) {
+            rings_[r].add(floor_div(epoch_minute, kBucketMinutes[r]), static_cast<size_t>(category));
+        }
+    }
+
+    // `count` rows into one ring only, for counts already bucketed elsewhere.
+    void add(Resolution resolution, long long epoch_minute, Category category, int count) {
+        rings_[resolution].add(floor_div(epoch_minute, kBucketMinutes[resolution]), static_cast<size_t>(category), count);
+    }
+
+    // Per-bucket counts, oldest first, for the `count` buckets ending with the
+    // one that holds `now_minute`. `category` nullopt counts every category.
+    std::vector<int> window(Resolution resolution, long long now_minute, int count, std::optional<Category> category) const {
+        const Ring& ring = rings_[resolution];
+        const long long last = floor_div(now_minute, kBucketMinutes[resolution]);
+        std::vector<int> out(static_cast<size_t>(std::max(0, count)), 0);
+        for (int i = 0; i < count; ++i) {
+            const long long bucket = last - (count - 1 - i);
+            if (const auto* slot = ring.find(bucket)) {
+                if (category) {
+                    out[i] = (*slot)[static_cast<size_t>(*category)];
+                } else {
+                    out[i] = std::accumulate(slot->begin(), slot->end(), 0);
+                }
+            }
+        }
+        return out;
+    }
+
+    static long long bucket_of(Resolution resolution, long long epoch_minute) {
+        return floor_div(epoch_minute, kBucketMinutes[resolution]);
+    }
+
+    // One row counted at `epoch_minute` changes category, in every ring that
+    // still holds its bucket.
+    void move(long long epoch_minute, Category from, Category to) {
+        for (size_t r = 0; r < kResolutionCount; ++r) {
+            Slot* slot = rings_[r].find(floor_div(epoch_minute, kBucketMinutes[r]));
+            if (slot && (*slot)[static_cast<size_t>(from)] > 0) {
+                --(*slot)[static_cast<size_t>(from)];
+                ++(*slot)[static_cast<size_t>(to)];
+            }
+        }
+    }
+
+    void encode_to(BinaryWriter& w) const {
+        for (const Ring& ring : rings_) {
+            w.i64(ring.newest);
+            for (const auto& slot : ring.slots) {
+                for (int v : slot) {
+                    w.i32(v);
+                }
+            }
+        }
+    }
+
+    void decode_from(BinaryReader& r) {
+        for (Ring& ring : rings_) {
+            ring.newest = r.i64();
+            for (auto& slot : ring.slots) {
+                for (int& v : slot) {
+                    v = r.i32();
+                }
+            }
+        }
+    }
+
+private:
+    using Slot = std::array<int, kCategoryCount>;
+
+    struct Ring {
+        static constexpr long long kEmpty = std::numeric_limits<long long>::min();
+
+        long long newest = kEmpty;
+        std::vector<Slot> slots;
+
+        void add(long long bucket, size_t category, int count = 1) {
+            const long long size = static_cast<long long>(slots.size());
+            if (newest == kEmpty) {
+                newest = bucket;
+            } else if (bucket > newest) {
+                // Recycle the slots the window slides over.
+                for (long long b = newest + 1; b <= bucket && b - newest <= size; ++b) {
+                    slots[index(b)].fill(0);
+                }
+                newest = bucket;
+            }
+            if (newest - bucket >= size) {
+                return;
+            }
+            slots[index(bucket)][category] += count;
+        }
+
+        const Slot* find(long long bucket) const {
+            if (newest == kEmpty || bucket > newest || newest - bucket >= static_cast<long long>(slots.size())) {
+                return nullptr;
+            }
+            return &slots[index(bucket)];
+        }
+
+        Slot* find(long long bucket) {
+            return const_cast<Slot*>(static_cast<const Ring&>(*this).find(bucket));
+        }
+
+        size_t index(long long bucket) const {
+            const long long size = static_cast<long long>(slots.size());
+            return static_cast<size_t>(((bucket % size) + size) % size);
+        }
+    };
+
+    std::array<Ring, kResolutionCount> rings_;
+
+    static long long floor_div(long long a, long long b) {
+        return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+    }
+};
+
+// Helper threads for the aggregation stages. run(tasks, fn) calls fn(task) for
+// every task in [0, tasks), spread over the helpers and the calling thread as
+// each takes the next task off a shared counter, and returns once all are
+// done. Sized by COMM0NS_TUI_AGG_THREADS, else the core count; with one
+// thread everything runs inline on the caller.
+class AggregationPool {
+public:
+    static constexpr size_t kMaxThreads = 16;
+
+    explicit AggregationPool(size_t threads = default_threads()) {
+        for (size_t i = 1; i < std::clamp<size_t>(threads, 1, kMaxThreads); ++i) {
+            helpers_.emplace_back([this]() { help(); });
+        }
+    }
+
+    ~AggregationPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& helper : helpers_) {
+            helper.join();
+        }
+    }
+
+    AggregationPool(const AggregationPool&) = delete;
+    AggregationPool& operator=(const AggregationPool&) = delete;
+
+    size_t threads() const { return helpers_.size() + 1; }
+
+    static size_t default_threads() {
+        const std::string forced = env_or_empty("COMM0NS_TUI_AGG_THREADS");
+        if (!forced.empty()) {
+            return static_cast<size_t>(std::max(1, std::atoi(forced.c_str())));
+        }
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    template <typename Fn>
+    void run(size_t tasks, Fn&& fn) {
+        if (helpers_.empty() || tasks <= 1) {
+            for (size_t task = 0; task < tasks; ++task) {
+                fn(task);
+            }
+            return;
+        }
+        using F = std::remove_reference_t<Fn>;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            fn_ = const_cast<void*>(static_cast<const void*>(&fn));
+            call_ = [](void* f, size_t task) { (*static_cast<F*>(f))(task); };
+            tasks_ = tasks;
+            next_ = 0;
+            busy_ = helpers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+        drain();
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&]() { return busy_ == 0; });
+    }
+
+private:
+    std::vector<std::thread> helpers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    // The current run; written under mutex_ before generation_ moves, and not
+    // touched again until every helper has checked back in.
+    void* fn_ = nullptr;
+    void (*call_)(void*, size_t) = nullptr;
+    size_t tasks_ = 0;
+    std::atomic<size_t> next_{0};
+    size_t busy_ = 0;
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+
+    void drain() {
+        for (size_t task = next_.fetch_add(1); task < tasks_; task = next_.fetch_add(1)) {
+            call_(fn_, task);
+        }
+    }
+
+    void help() {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+            lock.unlock();
+            drain();
+            lock.lock();
+            if (--busy_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+};
+
+// Running message/reaction aggregates kept by the refresh worker between loads.
+// A full sync rebuilds them from scratch; a delta sync folds in only the rows at
+// or past the timestamp high-water marks.
+//
+// Users and channels are interned into dense indices (stable until reset()),
+// and every aggregate is a flat array over those indices.
+class ActivityAggregator {
+public:
+    struct RecentMessage {
+        long long message_id;
+        long long user_id;
+        long long channel_id;
+        std::string content;
+        Category category;
+        std::string timestamp;
+        int stage2_percent = -1;  // confidence of a Stage2 verdict; -1 while Stage1's
+    };
+
+    static constexpr size_t kRecentCapacity = 64;
+    // Users and channels are split by index into this many shards for the
+    // parallel fold; each shard's counters are only ever written by one task.
+    static constexpr size_t kShards = AggregationPool::kMaxThreads;
+
+    // One page of messages for fold_messages(), as parallel columns. Interned
+    // by the caller; `ops` is the Stage1 ops flag of the row's channel. The
+    // last three columns are filled in by the fold. Reused across pages.
+    struct MessageBatch {
+        std::vector<long long> message_ids;
+        std::vector<uint32_t> users;
+        std::vector<uint32_t> channels;
+        std::vector<uint8_t> ops;
+        std::vector<std::string_view> contents;
+        std::vector<std::string_view> timestamps;
+        std::vector<std::optional<int>> days;
+        std::vector<uint8_t> folded;
+        std::vector<Category> categories;
+        std::vector<std::optional<long long>> minutes;
+        // Folded rows bucketed by user / channel shard, in row order; shard s
+        // owns [*_start[s], *_start[s + 1]).
+        std::vector<uint32_t> user_rows;
+        std::vector<uint32_t> channel_rows;
+        std::array<uint32_t, kShards + 1> user_start{};
+        std::array<uint32_t, kShards + 1> channel_start{};
+
+        size_t size() const { return message_ids.size(); }
+
+        void clear() {
+            message_ids.clear();
+            users.clear();
+            channels.clear();
+            ops.clear();
+            contents.clear();
+            timestamps.clear();
+            days.clear();
+        }
+
+        void add(long long message_id, uint32_t user, uint32_t channel, bool ops_channel, std::string_view content,
+                 std::string_view timestamp, std::optional<int> day) {
+            message_ids.push_back(message_id);
+            users.push_back(user);
+            channels.push_back(channel);
+            ops.push_back(ops_channel);
+            contents.push_back(content);
+            timestamps.push_back(timestamp);
+            days.push_back(day);
+        }
+    };
+
+    void reset() {
+        *this = ActivityAggregator();
+    }
+
+    bool synced() const { return synced_; }
+    void mark_synced() { synced_ = true; }
+
+    const std::string& message_mark() const { return message_mark_; }
+    const std::string& reaction_mark() const { return reaction_mark_; }
+
+    uint32_t intern_user(long long user_id) {
+        const uint32_t user = users_.intern(user_id);
+        if (user == user_reactions_.size()) {
+            for (auto& counts : user_categories_) {
+                counts.push_back(0);
+            }
+            user_reactions_.push_back(0);
+            user_days_.emplace_back();
+        }
+        return user;
+    }
+
+    uint32_t intern_channel(long long channel_id) {
+        const uint32_t channel = channels_.intern(channel_id);
+        if (channel == channel_totals_.size()) {
+            channel_totals_.push_back(0);
+            channel_active_users_.push_back(0);
+            channel_top_user_.push_back(0);
+            channel_top_count_.push_back(0);
+            channel_daily_.emplace_back();
+        }
+        return channel;
+    }
+
+    // Rows may arrive in any order. Returns false for a row already folded (a
+    // `gte.` delta re-sends the rows sitting exactly on the mark). `user` and
+    // `channel` come from intern_user()/intern_channel(); `category` is the
+    // Stage1 class of `content`.
+    bool fold_message(
+        long long message_id,
+        uint32_t user,
+        uint32_t channel,
+        Category category,
+        std::string_view content,
+        std::string_view timestamp,
+        std::optional<int> day
+    ) {
+        if (!advance_mark(message_mark_, message_keys_at_mark_, timestamp, {message_id, 0})) {
+            return false;
+        }
+        count_user_message(user, category, day);
+        count_channel_message(channel, user, category, day);
+        if (const std::optional<long long> minute = parse_epoch_minute(timestamp)) {
+            series_.add(*minute, category);
+        }
+        remember_recent(message_id, users_.id(user), channels_.id(channel), content, category, timestamp);
+        return true;
+    }
+
+    // fold_message() over a page, with the per-row work spread over `pool`:
+    // rows pass the marks in order, are classified in chunks, then counted one
+    // shard per task, each task taking the rows of its shard's users and
+    // channels. The series and the feed see the rows in order at the end, so
+    // the result matches folding them one by one. batch.folded marks the rows
+    // taken.
+    size_t fold_messages(MessageBatch& batch, AggregationPool& pool) {
+        const size_t n = batch.size();
+        batch.folded.resize(n);
+        batch.categories.resize(n);
+        batch.minutes.resize(n);
+        size_t folded = 0;
+        for (size_t i = 0; i < n; ++i) {
+            batch.folded[i] = advance_mark(message_mark_, message_keys_at_mark_, batch.timestamps[i], {batch.message_ids[i], 0});
+            folded += batch.folded[i];
+        }
+
+        constexpr size_t kChunk = 128;
+        pool.run((n + kChunk - 1) / kChunk, [&](size_t chunk) {
+            const size_t end = std::min(n, (chunk + 1) * kChunk);
+            for (size_t i = chunk * kChunk; i < end; ++i) {
+                if (batch.folded[i]) {
+                    batch.categories[i] = classify_stage1(batch.ops[i], batch.contents[i]);
+                    batch.minutes[i] = parse_epoch_minute(batch.timestamps[i]);
+                }
+            }
+        });
+
+        // A small page, or a pool without helpers, is counted in row order below.
+        const bool sharded = pool.threads() > 1 && n >= kChunk;
+        if (sharded) {
+            bucket_by_shard(batch);
+            pool.run(kShards, [&](size_t shard) {
+                for (uint32_t k = batch.user_start[shard]; k < batch.user_start[shard + 1]; ++k) {
+                    const uint32_t i = batch.user_rows[k];
+                    count_user_message(batch.users[i], batch.categories[i], batch.days[i]);
+                }
+                for (uint32_t k = batch.channel_start[shard]; k < batch.channel_start[shard + 1]; ++k) {
+                    const uint32_t i = batch.channel_rows[k];
+                    count_channel_message(batch.channels[i], batch.users[i], batch.categories[i], batch.days[i]);
+                }
+            });
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            if (!batch.folded[i]) {
+                continue;
+            }
+            if (!sharded) {
+                count_user_message(batch.users[i], batch.categories[i], batch.days[i]);
+                count_channel_message(batch.channels[i], batch.users[i], batch.categories[i], batch.days[i]);
+            }
+            if (batch.minutes[i]) {
+                series_.add(*batch.minutes[i], batch.categories[i]);
+            }
+            remember_recent(batch.message_ids[i], users_.id(batch.users[i]), channels_.id(batch.channels[i]),
+                            batch.contents[i], batch.categories[i], batch.timestamps[i]);
+        }
+        return folded;
+    }
+
+    bool fold_reaction(long long message_id, long long reactor_id, std::string_view created_at, std::optional<int> day) {
+        if (!advance_mark(reaction_mark_, reaction_keys_at_mark_, created_at, {message_id, reactor_id})) {
+            return false;
+        }
+        const uint32_t user = intern_user(reactor_id);
+        user_reactions_[user] += 1;
+        if (day) {
+            user_days_[user].set(*day);
+        }
+        return true;
+    }
+
+    // Seeding from the server-side rollups (migrations/006): one row is a day of
+    // a user's messages in a channel, per category. The series gets the day ring
+    // here and the minute/hour rings from fold_minute_rollup().
+    void fold_rollup(uint32_t user, uint32_t channel, int day, const std::array<int, kCategoryCount>& counts) {
+        int total = 0;
+        int cp = 0;
+        for (size_t cat = 0; cat < kCategoryCount; ++cat) {
+            if (counts[cat] <= 0) {
+                continue;
+            }
+            user_categories_[cat][user] += counts[cat];
+            series_.add(ActivitySeries::kDays, static_cast<long long>(day) * 1440, static_cast<Category>(cat), counts[cat]);
+            total += counts[cat];
+            cp += counts[cat] * base_cp(static_cast<Category>(cat));
+        }
+        if (total == 0) {
+            return;
+        }
+        channel_totals_[channel] += total;
+        bool first_post = false;
+        ChannelUserTally& tally = channel_users(channel).get(channel_user_key(channel, user), first_post);
+        tally.posts += total;
+        tally.base_cp += cp;
+        channel_active_users_[channel] += first_post;
+        if (tally.posts > channel_top_count_[channel]) {
+            channel_top_count_[channel] = tally.posts;
+            channel_top_user_[channel] = user;
+        }
+        channel_daily_[channel].add(day, total);
+        user_days_[user].set(day);
+    }
+
+    void fold_minute_rollup(long long epoch_minute, const std::array<int, kCategoryCount>& counts) {
+        for (size_t cat = 0; cat < kCategoryCount; ++cat) {
+            if (counts[cat] > 0) {
+                series_.add(ActivitySeries::kMinutes, epoch_minute, static_cast<Category>(cat), counts[cat]);
+                series_.add(ActivitySeries::kHours, epoch_minute, static_cast<Category>(cat), counts[cat]);
+            }
+        }
+    }
+
+    void fold_reaction_rollup(long long reactor_id, int day, int count) {
+        const uint32_t user = intern_user(reactor_id);
+        user_reactions_[user] += count;
+        user_days_[user].set(day);
+    }
+
+    // A message the rollups already counted: only shown in the feed.
+    void add_recent(long long message_id, long long user_id, long long channel_id, std::string_view content,
+                    Category category, std::string_view timestamp) {
+        remember_recent(message_id, user_id, channel_id, content, category, timestamp);
+    }
+
+    // A Stage2 verdict for a message counted as `from`: moves it to `to` in the
+    // per-user counts, its channel tally's CP, the series and the feed. Per-day
+    // and per-channel totals do not depend on the category. Users or channels
+    // the aggregates do not hold are left alone.
+    void reclassify(long long message_id, long long user_id, long long channel_id, std::optional<long long> minute,
+                    Category from, Category to, int confidence_percent) {
+        for (RecentMessage& m : recent_) {
+            if (m.message_id == message_id) {
+                m.category = to;
+                m.stage2_percent = confidence_percent;
+            }
+        }
+        const std::optional<uint32_t> user = users_.find(user_id);
+        const std::optional<uint32_t> channel = channels_.find(channel_id);
+        if (from == to || !user || !channel) {
+            return;
+        }
+        int& was = user_categories_[static_cast<size_t>(from)][*user];
+        if (was <= 0) {
+            return;
+        }
+        --was;
+        ++user_categories_[static_cast<size_t>(to)][*user];
+        if (ChannelUserTally* tally = channel_users(*channel).find(channel_user_key(*channel, *user))) {
+            tally->base_cp += base_cp(to) - base_cp(from);
+        }
+        if (minute) {
+            series_.move(*minute, from, to);
+        }
+    }
+
+    // The rollups cover everything before `through`; deltas continue from it.
+    void resume_from(std::string_view through) {
+        message_mark_.assign(through.data(), through.size());
+        reaction_mark_ = message_mark_;
+        message_keys_at_mark_.clear();
+        reaction_keys_at_mark_.clear();
+    }
+
+    std::optional<uint32_t> find_user(long long user_id) const { return users_.find(user_id); }
+    long long user_id(uint32_t user) const { return users_.id(user); }
+    int category_count(uint32_t user, Category category) const {
+        return user_categories_[static_cast<size_t>(category)][user];
+    }
+    int reactions(uint32_t user) const { return user_reactions_[user]; }
+    const DayBitmap& active_days(uint32_t user) const { return user_days_[user]; }
+
+    size_t channel_count() const { return channels_.size(); }
+    std::optional<uint32_t> find_channel(long long channel_id) const { return channels_.find(channel_id); }
+    long long channel_id(uint32_t channel) const { return channels_.id(channel); }
+    int channel_total(uint32_t channel) const { return channel_totals_[channel]; }
+    int channel_active_users(uint32_t channel) const { return channel_active_users_[channel]; }
+    const DayCounts& channel_daily(uint32_t channel) const { return channel_daily_[channel]; }
+    // Most active poster, or nullopt for a channel without messages.
+    std::optional<uint32_t> channel_champion(uint32_t channel) const {
+        return channel_top_count_[channel] > 0 ? std::optional<uint32_t>(channel_top_user_[channel]) : std::nullopt;
+    }
+
+    // fn(channel, user, base_cp) for every (channel, user) pair with messages;
+    // base_cp is base_cp() summed over them.
+    template <typename Fn>
+    void for_each_channel_user(Fn fn) const {
+        for (const auto& shard : channel_users_) {
+            shard.for_each([&](uint64_t key, const ChannelUserTally& tally) {
+                fn(static_cast<uint32_t>((key - 1) >> 32), static_cast<uint32_t>(key - 1), tally.base_cp);
+            });
+        }
+    }
+
+    const std::deque<RecentMessage>& recent_messages() const { return recent_; }  // newest first
+
+    const ActivitySeries& series() const { return series_; }
+
+    void encode_to(BinaryWriter& w) const {
+        w.boolean(synced_);
+        w.str(message_mark_);
+        w.str(reaction_mark_);
+        for (const auto* keys : {&message_keys_at_mark_, &reaction_keys_at_mark_}) {
+            w.u32(static_cast<uint32_t>(keys->size()));
+            for (const auto& key : *keys) {
+                w.i64(key.first);
+                w.i64(key.second);
+            }
+        }
+
+        // Dense indices are stored implicitly: entries are written in index order.
+        w.u32(static_cast<uint32_t>(users_.size()));
+        for (uint32_t u = 0; u < users_.size(); ++u) {
+            w.i64(users_.id(u));
+            for (const auto& counts : user_categories_) {
+                w.i32(counts[u]);
+            }
+            w.i32(user_reactions_[u]);
+            encode(w, user_days_[u]);
+        }
+
+        w.u32(static_cast<uint32_t>(channels_.size()));
+        for (uint32_t c = 0; c < channels_.size(); ++c) {
+            w.i64(channels_.id(c));
+            w.i32(channel_totals_[c]);
+            w.i32(channel_active_users_[c]);
+            w.u32(channel_top_user_[c]);
+            w.i32(channel_top_count_[c]);
+            encode(w, channel_daily_[c]);
+        }
+
+        size_t pairs = 0;
+        for (const auto& shard : channel_users_) {
+            pairs += shard.size();
+        }
+        w.u32(static_cast<uint32_t>(pairs));
+        for (const auto& shard : channel_users_) {
+            shard.for_each([&](uint64_t key, const ChannelUserTally& tally) {
+                w.u64(key);
+                w.i32(tally.posts);
+                w.i32(tally.base_cp);
+            });
+        }
+
+        w.u32(static_cast<uint32_t>(recent_.size()));
+        for (const auto& m : recent_) {
+            w.i64(m.message_id);
+            w.i64(m.user_id);
+            w.i64(m.channel_id);
+            w.str(m.content);
+            w.u8(static_cast<uint8_t>(m.category));
+            w.str(m.timestamp);
+            encode_stage2_percent(w, m.stage2_percent);
+        }
+
+        series_.encode_to(w);
+    }
+
+    bool decode_from(BinaryReader& r) {
+        reset();
+        synced_ = r.boolean();
+        message_mark_ = r.str();
+        reaction_mark_ = r.str();
+        for (auto* keys : {&message_keys_at_mark_, &reaction_keys_at_mark_}) {
+            const uint32_t n = r.count();
+            for (uint32_t i = 0; i < n; ++i) {
+                const long long first = r.i64();
+                keys->push_back({first, r.i64()});
+            }
+        }
+
+        const uint32_t user_count = r.count();
+        for (uint32_t i = 0; i < user_count && r.ok(); ++i) {
+            const uint32_t u = intern_user(r.i64());
+            for (auto& counts : user_categories_) {
+                counts[u] = r.i32();
+            }
+            user_reactions_[u] = r.i32();
+            decode(r, user_days_[u]);
+        }
+
+        const uint32_t channel_count = r.count();
+        for (uint32_t i = 0; i < channel_count && r.ok(); ++i) {
+            const uint32_t c = intern_channel(r.i64());
+            channel_totals_[c] = r.i32();
+            channel_active_users_[c] = r.i32();
+            channel_top_user_[c] = r.u32();
+            channel_top_count_[c] = r.i32();
+            decode(r, channel_daily_[c]);
+        }
+
+        const uint32_t pair_count = r.count();
+        for (uint32_t i = 0; i < pair_count && r.ok(); ++i) {
+            const uint64_t key = r.u64();
+            bool inserted = false;
+            ChannelUserTally& tally = channel_users(static_cast<uint32_t>((key - 1) >> 32)).get(key, inserted);
+            tally.posts = r.i32();
+            tally.base_cp = r.i32();
+        }
+
+        const uint32_t recent_count = r.count();
+        for (uint32_t i = 0; i < recent_count && r.ok(); ++i) {
+            RecentMessage m{};
+            m.message_id = r.i64();
+            m.user_id = r.i64();
+            m.channel_id = r.i64();
+            m.content = r.str();
+            m.category = static_cast<Category>(std::min<uint8_t>(r.u8(), static_cast<uint8_t>(Category::Misc)));
+            m.timestamp = r.str();
+            m.stage2_percent = decode_stage2_percent(r);
+            recent_.push_back(std::move(m));
+        }
+
+        series_.decode_from(r);
+
+        bool indices_ok = true;
+        for (uint32_t c = 0; c < channels_.size(); ++c) {
+            indices_ok = indices_ok && channel_top_user_[c] < users_.size();
+        }
+        if (!r.ok() || !indices_ok) {
+            reset();
+            return false;
+        }
+        return true;
+    }
+
+private:
+    using RowKey = std::pair<long long, long long>;
+
+    bool synced_ = false;
+    std::string message_mark_;
+    std::string reaction_mark_;
+    std::vector<RowKey> message_keys_at_mark_;
+    std::vector<RowKey> reaction_keys_at_mark_;
+
+    IdIndex users_;
+    std::array<std::vector<int>, kCategoryCount> user_categories_;
+    std::vector<int> user_reactions_;
+    std::vector<DayBitmap> user_days_;
+
+    IdIndex channels_;
+    std::vector<int> channel_totals_;
+    std::vector<int> channel_active_users_;
+    std::vector<uint32_t> channel_top_user_;
+    std::vector<int> channel_top_count_;
+    std::vector<DayCounts> channel_daily_;
+    struct ChannelUserTally {
+        int posts = 0;
+        int base_cp = 0;  // base_cp() summed over the posts
+    };
+    // Sharded by channel, so the parallel fold's tasks never share a table.
+    std::array<FlatTable<ChannelUserTally>, kShards> channel_users_;
+
+    std::deque<RecentMessage> recent_;
+    ActivitySeries series_;
+
+    // Offset by one so (channel 0, user 0) is not the empty key.
+    static uint64_t channel_user_key(uint32_t channel, uint32_t user) {
+        return ((static_cast<uint64_t>(channel) << 32) | user) + 1;
+    }
+
+    FlatTable<ChannelUserTally>& channel_users(uint32_t channel) { return channel_users_[channel % kShards]; }
+
+    // Counting sort of the folded rows by user and by channel shard, stable so
+    // each shard still counts its rows in page order (champion ties included).
+    static void bucket_by_shard(MessageBatch& batch) {
+        batch.user_start.fill(0);
+        batch.channel_start.fill(0);
+        size_t folded = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (batch.folded[i]) {
+                ++batch.user_start[batch.users[i] % kShards + 1];
+                ++batch.channel_start[batch.channels[i] % kShards + 1];
+                ++folded;
+            }
+        }
+        for (size_t shard = 0; shard < kShards; ++shard) {
+            batch.user_start[shard + 1] += batch.user_start[shard];
+            batch.channel_start[shard + 1] += batch.channel_start[shard];
+        }
+        batch.user_rows.resize(folded);
+        batch.channel_rows.resize(folded);
+        std::array<uint32_t, kShards> user_next;
+        std::array<uint32_t, kShards> channel_next;
+        std::copy_n(batch.user_start.begin(), kShards, user_next.begin());
+        std::copy_n(batch.channel_start.begin(), kShards, channel_next.begin());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (batch.folded[i]) {
+                batch.user_rows[user_next[batch.users[i] % kShards]++] = static_cast<uint32_t>(i);
+                batch.channel_rows[channel_next[batch.channels[i] % kShards]++] = static_cast<uint32_t>(i);
+            }
+        }
+    }
+
+    // The per-user and per-channel halves of a message. The parallel fold calls
+    // them from the task owning the user's / channel's shard.
+    void count_user_message(uint32_t user, Category category, std::optional<int> day) {
+        user_categories_[static_cast<size_t>(category)][user] += 1;
+        if (day) {
+            user_days_[user].set(*day);
+        }
+    }
+
+    void count_channel_message(uint32_t channel, uint32_t user, Category category, std::optional<int> day) {
+        channel_totals_[channel] += 1;
+        bool first_post = false;
+        ChannelUserTally& tally = channel_users(channel).get(channel_user_key(channel, user), first_post);
+        tally.posts += 1;
+        tally.base_cp += base_cp(category);
+        channel_active_users_[channel] += first_post;
+        // The first user to reach a count keeps the lead on ties.
+        if (tally.posts > channel_top_count_[channel]) {
+            channel_top_count_[channel] = tally.posts;
+            channel_top_user_[channel] = user;
+        }
+        if (day) {
+            channel_daily_[channel].add(*day);
+        }
+    }
+
+    // Checked before copying anything: on a full sync almost every row misses.
+    void remember_recent(
+        long long message_id,
+        long long user_id,
+        long long channel_id,
+        std::string_view content,
+        Category category,
+        std::string_view timestamp
+    ) {
+        if (recent_.size() >= kRecentCapacity && timestamp < recent_.back().timestamp) {
+            return;
+        }
+        const auto pos = std::find_if(recent_.begin(), recent_.end(), [&](const RecentMessage& r) {
+            return r.timestamp <= timestamp;
+        }) - recent_.begin();
+        // Rows mostly arrive oldest first, so a full list turns over once per row:
+        // recycle the evicted entry's string buffers for the new one.
+        RecentMessage entry{};
+        if (recent_.size() >= kRecentCapacity) {
+            entry = std::move(recent_.back());
+            recent_.pop_back();
+        }
+        entry.message_id = message_id;
+        entry.user_id = user_id;
+        entry.channel_id = channel_id;
+        entry.content.assign(content.data(), content.size());
+        entry.category = category;
+        entry.timestamp.assign(timestamp.data(), timestamp.size());
+        entry.stage2_percent = -1;
+        recent_.insert(recent_.begin() + pos, std::move(entry));
+    }
+
+    // PostgREST renders timestamptz with a fixed offset, so string order is time
+    // order. Keys seen exactly at the mark are remembered to drop boundary repeats;
+    // there are only ever a handful, so a vector beats a set.
+    static bool advance_mark(
+        std::string& mark,
+        std::vector<RowKey>& keys_at_mark,
+        std::string_view timestamp,
+        RowKey key
+    ) {
+        if (timestamp.empty() || timestamp < mark) {
+            return true;
+        }
+        if (timestamp == mark) {
+            if (std::find(keys_at_mark.begin(), keys_at_mark.end(), key) != keys_at_mark.end()) {
+                return false;
+            }
+            keys_at_mark.push_back(key);
+            return true;
+        }
+        mark.assign(timestamp.data(), timestamp.size());
+        keys_at_mark.clear();
+        keys_at_mark.push_back(key);
+        return true;
+    }
+};
+
+// Everything one load produces for the UI. Built on the refresh worker and
+// handed to the UI thread as a whole, so the UI never sees a half-built state.
+struct DashboardSnapshot {
+    std::vector<Member> members;
+    std::vector<Channel> channels;
+    std::vector<Vote> votes;
+    std::vector<Issue> issues;
+    std::vector<FeedItem> feed;
+    std::vector<MessageSample> samples;
+    Sprint sprint;
+    ActivitySeries series;
+    std::vector<std::pair<int, int>> daily_pulse;  // (day serial, total) from analytics_daily_pulse
+    ScoringBasis scoring;
+    bool members_table_available = false;
+    bool votes_table_available = false;
+    bool issues_table_available = false;
+    // DashboardApp::QueryIndex bits of the tables the first load left for the
+    // prefetch, shown as loading rather than missing. Not encoded.
+    unsigned loading_tables = 0;
+    int stage2_queue = -1;  // messages waiting for Stage2; -1 without a classifier
+    std::string refreshed_hms;
+};
+
+// Independently encoded parts of a snapshot. The cache stores them back to
+// back; --serve ships only the ones that changed since a client's version.
+enum SnapshotSection : uint8_t {
+    kMembersSection,
+    kChannelsSection,
+    kVotesSection,
+    kIssuesSection,
+    kFeedSection,
+    kSamplesSection,
+    kSprintSection,
+    kSeriesSection,
+    kPulseSection,
+    kStatusSection,
+    kScoringSection,
+    kSnapshotSectionCount
+};
+
+void encode_section(BinaryWriter& w, const DashboardSnapshot& snap, SnapshotSection section) {
+    switch (section) {
+        case kMembersSection: encode(w, snap.members); break;
+        case kChannelsSection: encode(w, snap.channels); break;
+        case kVotesSection: encode(w, snap.votes); break;
+        case kIssuesSection: encode(w, snap.issues); break;
+        case kFeedSection: encode(w, snap.feed); break;
+        case kSamplesSection: encode(w, snap.samples); break;
+        case kSprintSection: encode(w, snap.sprint); break;
+        case kSeriesSection: snap.series.encode_to(w); break;
+        case kPulseSection:
+            w.u32(static_cast<uint32_t>(snap.daily_pulse.size()));
+            for (const auto& day : snap.daily_pulse) {
+                w.i32(day.first);
+                w.i32(day.second);
+            }
+            break;
+        case kStatusSection:
+            w.boolean(snap.members_table_available);
+            w.boolean(snap.votes_table_available);
+            w.boolean(snap.issues_table_available);
+            w.i32(snap.stage2_queue);
+            w.str(snap.refreshed_hms);
+            break;
+        case kScoringSection: encode(w, snap.scoring); break;
+        case kSnapshotSectionCount: break;
+    }
+}
+
+void decode_section(BinaryReader& r, DashboardSnapshot& snap, SnapshotSection section) {
+    switch (section) {
+        case kMembersSection: decode(r, snap.members); break;
+        case kChannelsSection: decode(r, snap.channels); break;
+        case kVotesSection: decode(r, snap.votes); break;
+        case kIssuesSection: decode(r, snap.issues); break;
+        case kFeedSection: decode(r, snap.feed); break;
+        case kSamplesSection: decode(r, snap.samples); break;
+        case kSprintSection: decode(r, snap.sprint); break;
+        case kSeriesSection: snap.series.decode_from(r); break;
+        case kPulseSection: {
+            const uint32_t pulse_days = r.count();
+            for (uint32_t i = 0; i < pulse_days; ++i) {
+                const int day = r.i32();
+                snap.daily_pulse.push_back({day, r.i32()});
+            }
+            break;
+        }
+        case kStatusSection:
+            snap.members_table_available = r.boolean();
+            snap.votes_table_available = r.boolean();
+            snap.issues_table_available = r.boolean();
+            snap.stage2_queue = r.i32();
+            snap.refreshed_hms = r.str();
+            break;
+        case kScoringSection: decode(r, snap.scoring); break;
+        case kSnapshotSectionCount: break;
+    }
+}
+
+void encode(BinaryWriter& w, const DashboardSnapshot& snap) {
+    for (uint8_t section = 0; section < kSnapshotSectionCount; ++section) {
+        encode_section(w, snap, static_cast<SnapshotSection>(section));
+    }
+}
+
+void decode(BinaryReader& r, DashboardSnapshot& snap) {
+    for (uint8_t section = 0; section < kSnapshotSectionCount; ++section) {
+        decode_section(r, snap, static_cast<SnapshotSection>(section));
+    }
+}
+
+// $COMM0NS_TUI_CACHE, else $XDG_CACHE_HOME/comm0ns_tui or ~/.cache/comm0ns_tui;
+// empty when none is set.
+std::string cache_dir() {
+    const std::string dir = env_or_empty("COMM0NS_TUI_CACHE");
+    if (!dir.empty()) {
+        return dir;
+    }
+    const std::string xdg = env_or_empty("XDG_CACHE_HOME");
+    if (!xdg.empty()) {
+        return xdg + "/comm0ns_tui";
+    }
+    const std::string home = env_or_empty("HOME");
+    return home.empty() ? std::string() : home + "/.cache/comm0ns_tui";
+}
+
+// Last good snapshot plus the worker's aggregates, so a restart paints at once
+// and resumes with a delta sync. Stored per SUPABASE_URL under
+// $COMM0NS_TUI_CACHE, $XDG_CACHE_HOME/comm0ns_tui or ~/.cache/comm0ns_tui.
+class SnapshotCache {
+public:
+    static constexpr uint32_t kMagic = 0x53543043;  // "C0TS"
+    static constexpr uint32_t kVersion = 8;
+
+    SnapshotCache() : path_(default_path()) {}
+
+    bool load(DashboardSnapshot& snap, ActivityAggregator& activity) const {
+        if (path_.empty()) {
+            return false;
+        }
+        const int fd = ::open(path_.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        const size_t size = static_cast<size_t>(st.st_size);
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+
+        BinaryReader r(static_cast<const char*>(mapped), size);
+        bool ok = r.u32() == kMagic && r.u32() == kVersion && r.str() == env_or_empty("SUPABASE_URL");
+        if (ok) {
+            decode(r, snap);
+            ok = r.ok() && activity.decode_from(r);
+        }
+        ::munmap(mapped, size);
+        return ok;
+    }
+
+    // Written to a temp file and renamed, so a crash never leaves a torn cache.
+    void store(const DashboardSnapshot& snap, const ActivityAggregator& activity) const {
+        if (path_.empty()) {
+            return;
+        }
+        BinaryWriter w;
+        w.u32(kMagic);
+        w.u32(kVersion);
+        w.str(env_or_empty("SUPABASE_URL"));
+        encode(w, snap);
+        activity.encode_to(w);
+
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path_).parent_path(), ec);
+        const std::string tmp = path_ + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return;
+            }
+            out.write(w.data().data(), static_cast<std::streamsize>(w.data().size()));
+            if (!out) {
+                return;
+            }
+        }
+        std::filesystem::rename(tmp, path_, ec);
+    }
+
+private:
+    std::string path_;
+
+    static std::string default_path() {
+        const std::string dir = cache_dir();
+        return dir.empty() ? std::string() : dir + "/snapshot.bin";
+    }
+};
+
+// Append-only log of the messages and reactions folded into the aggregates, for
+// --replay and as the benchmark's corpus. The log file is a header and then
+// fixed-width EventRecords in append order; content bytes live in the
+// companion ".text" file at the offset a record names. Channels and users are
+// records too (when first seen and when a name or score changes), so a log
+// replays without the database. Both files only ever grow.
+enum class EventKind : uint8_t { Message, Reaction, Channel, User };
+
+struct EventRecord {
+    int64_t id;        // message (for a reaction, the one reacted to), channel or user id
+    int64_t actor;     // author / reactor; a User record's current_score x 100
+    int64_t time;      // epoch seconds
+    uint64_t text;     // text-file offset << 16 | length
+    int32_t day;       // day serial of the source timestamp, in its own offset
+    uint16_t channel;  // log channel index (Message and Channel records)
+    uint8_t kind;      // EventKind
+    uint8_t category;  // Category of a Message
+
+    uint64_t text_offset() const { return text >> 16; }
+    size_t text_size() const { return static_cast<size_t>(text & 0xffff); }
+};
+static_assert(sizeof(EventRecord) == 40, "EventRecord is the on-disk layout");
+
+constexpr uint32_t kEventLogMagic = 0x45543043;  // "C0TE"
+constexpr uint32_t kEventLogVersion = 1;
+constexpr size_t kEventLogHeader = 8;  // u32 magic, u32 version
+constexpr size_t kMaxEventText = 0xffff;
+constexpr uint16_t kMaxLogChannels = 0xffff;
+
+// Writes all of `data`, retrying short writes; false on an error.
+bool write_all(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::write(fd, p, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Read-only mapping of a whole file; an empty file maps to an empty view.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { reset(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        reset();
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        bool ok = ::fstat(fd, &st) == 0;
+        if (ok && st.st_size > 0) {
+            void* mapped = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ok = mapped != MAP_FAILED;
+            if (ok) {
+                data_ = static_cast<const char*>(mapped);
+                size_ = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+    void reset() {
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+};
+
+class EventLogView {
+public:
+    // False (with `error`) unless `path` is an event log of this version. A torn
+    // trailing record is ignored.
+    bool open(const std::string& path, std::string& error) {
+        if (!records_.open(path)) {
+            error = path + ": " + std::strerror(errno);
+            return false;
+        }
+        uint32_t header[2] = {0, 0};
+        if (records_.size() >= kEventLogHeader) {
+            std::memcpy(header, records_.data(), sizeof(header));
+        }
+        if (header[0] != kEventLogMagic || header[1] != kEventLogVersion) {
+            error = path + ": not a comm0ns_tui event log (or another version)";
+            return false;
+        }
+        if (!text_.open(path + ".text")) {
+            error = path + ".text: " + std::strerror(errno);
+            return false;
+        }
+        count_ = (records_.size() - kEventLogHeader) / sizeof(EventRecord);
+        return true;
+    }
+
+    size_t size() const { return count_; }
+
+    // The mapping is page aligned and the header is 8 bytes, so records are
+    // naturally aligned in place.
+    const EventRecord& operator[](size_t i) const {
+        return reinterpret_cast<const EventRecord*>(records_.data() + kEventLogHeader)[i];
+    }
+
+    std::string_view text(const EventRecord& record) const {
+        const uint64_t offset = record.text_offset();
+        if (offset > text_.size() || record.text_size() > text_.size() - offset) {
+            return {};
+        }
+        return std::string_view(text_.data() + offset, record.text_size());
+    }
+
+private:
+    MappedFile records_;
+    MappedFile text_;
+    size_t count_ = 0;
+};
+
+// Writer half, owned by the refresh worker. Appends are buffered and land on
+// flush(), text before records, so a record never points past the text file.
+class EventLog {
+public:
+    ~EventLog() { close(); }
+
+    // One log per SUPABASE_URL in the cache directory; empty without one.
+    static std::string default_path() {
+        const std::string dir = cache_dir();
+        if (dir.empty()) {
+            return {};
+        }
+        char name[40];
+        std::snprintf(name, sizeof(name), "/events-%016llx.log",
+                      static_cast<unsigned long long>(std::hash<std::string>{}(env_or_empty("SUPABASE_URL"))));
+        return dir + name;
+    }
+
+    // Continues the log at `path`, creating it when missing. Anything else there
+    // (another format, unreadable) leaves logging off rather than clobbering it.
+    void open(const std::string& path) {
+        close();
+        if (path.empty()) {
+            return;
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        struct stat st{};
+        const bool exists = ::stat(path.c_str(), &st) == 0 && st.st_size > 0;
+        // A second instance on the same cache (a TUI next to --serve) would log
+        // every row twice: only the first one to lock the log writes it.
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ >= 0 && ::flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+            close();
+            return;
+        }
+        if (exists && !restore(path)) {
+            close();
+            return;
+        }
+        text_fd_ = ::open((path + ".text").c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        struct stat text_st{};
+        if (fd_ < 0 || text_fd_ < 0 || ::fstat(text_fd_, &text_st) != 0) {
+            close();
+            return;
+        }
+        text_size_ = static_cast<uint64_t>(text_st.st_size);
+        // Drop a torn trailing record; appends then follow the last whole one.
+        const off_t end = exists
+            ? static_cast<off_t>(kEventLogHeader + (static_cast<size_t>(st.st_size) - kEventLogHeader) / sizeof(EventRecord) * sizeof(EventRecord))
+            : 0;
+        if (::ftruncate(fd_, end) != 0) {
+            close();
+            return;
+        }
+        if (!exists) {
+            const uint32_t header[2] = {kEventLogMagic, kEventLogVersion};
+            if (!write_all(fd_, header, sizeof(header))) {
+                close();
+            }
+        }
+    }
+
+    bool enabled() const { return fd_ >= 0; }
+
+    // Rows the aggregator folds anew. Those not newer than what the last flush
+    // left in the log are taken as logged already (a full resync walks the
+    // history again); between flushes rows may come in any order, as a full
+    // sync's keyset pages do.
+    void append_message(long long message_id, long long user_id, long long channel_id, std::string_view channel_name,
+                        Category category, std::string_view content, std::string_view timestamp, std::optional<int> day) {
+        if (!enabled()) {
+            return;
+        }
+        const std::optional<long long> time = parse_epoch_second(timestamp);
+        if (!time || !messages_.admit(*time, {message_id, 0})) {
+            return;
+        }
+        const std::optional<uint16_t> channel = intern_channel(channel_id, channel_name, *time);
+        if (!channel) {
+            return;
+        }
+        push({message_id, user_id, *time, 0, day.value_or(0), *channel, static_cast<uint8_t>(EventKind::Message),
+              static_cast<uint8_t>(category)}, content);
+    }
+
+    void append_reaction(long long message_id, long long reactor_id, std::string_view created_at, std::optional<int> day) {
+        if (!enabled()) {
+            return;
+        }
+        const std::optional<long long> time = parse_epoch_second(created_at);
+        if (time && reactions_.admit(*time, {message_id, reactor_id})) {
+            push({message_id, reactor_id, *time, 0, day.value_or(0), 0, static_cast<uint8_t>(EventKind::Reaction), 0}, {});
+        }
+    }
+
+    // A users row; logged when it is new or its name or score moved.
+    void note_user(long long user_id, std::string_view name, double score) {
+        if (!enabled()) {
+            return;
+        }
+        const int64_t cents = static_cast<int64_t>(std::llround(score * 100.0));
+        const size_t name_hash = std::hash<std::string_view>{}(name);
+        auto [it, inserted] = users_.try_emplace(user_id, UserState{name_hash, cents});
+        if (!inserted && it->second.name_hash == name_hash && it->second.score == cents) {
+            return;
+        }
+        it->second = {name_hash, cents};
+        push({user_id, cents, static_cast<int64_t>(std::time(nullptr)), 0, 0, 0, static_cast<uint8_t>(EventKind::User), 0}, name);
+    }
+
+    void flush() {
+        if (!enabled() || pending_.empty()) {
+            return;
+        }
+        if (!write_all(text_fd_, pending_text_.data(), pending_text_.size()) ||
+            !write_all(fd_, pending_.data(), pending_.size() * sizeof(EventRecord))) {
+            close();  // a short write (disk full...) ends logging for this run
+        }
+        text_size_ += pending_text_.size();
+        pending_.clear();
+        pending_text_.clear();
+        messages_.settle();
+        reactions_.settle();
+    }
+
+private:
+    using RowKey = std::pair<long long, long long>;
+    // Newest time in the log and the keys logged at it: `floor` as of the last
+    // flush, `newest` including the appends since.
+    class Mark {
+    public:
+        bool admit(int64_t time, RowKey key) {
+            if (time < floor_ || (time == floor_ && contains(floor_keys_, key))) {
+                return false;
+            }
+            if (time > newest_) {
+                newest_ = time;
+                newest_keys_.clear();
+            }
+            if (time == newest_) {
+                newest_keys_.push_back(key);
+            }
+            return true;
+        }
+
+        void settle() {
+            floor_ = newest_;
+            floor_keys_ = newest_keys_;
+        }
+
+    private:
+        int64_t floor_ = std::numeric_limits<int64_t>::min();
+        int64_t newest_ = std::numeric_limits<int64_t>::min();
+        std::vector<RowKey> floor_keys_;
+        std::vector<RowKey> newest_keys_;
+
+        static bool contains(const std::vector<RowKey>& keys, RowKey key) {
+            return std::find(keys.begin(), keys.end(), key) != keys.end();
+        }
+    };
+    struct UserState {
+        size_t name_hash;
+        int64_t score;
+    };
+
+    int fd_ = -1;
+    int text_fd_ = -1;
+    uint64_t text_size_ = 0;  // flushed text bytes
+    std::vector<EventRecord> pending_;
+    std::string pending_text_;
+    Mark messages_;
+    Mark reactions_;
+    std::unordered_map<long long, uint16_t> channel_index_;
+    std::vector<std::string> channel_names_;  // by log channel index
+    std::unordered_map<long long, UserState> users_;
+
+    void close() {
+        for (int* fd : {&fd_, &text_fd_}) {
+            if (*fd >= 0) {
+                ::close(*fd);
+                *fd = -1;
+            }
+        }
+        pending_.clear();
+        pending_text_.clear();
+    }
+
+    // Picks up where an earlier run stopped: channel indices, user state and marks.
+    bool restore(const std::string& path) {
+        EventLogView view;
+        std::string error;
+        if (!view.open(path, error)) {
+            return false;
+        }
+        for (size_t i = 0; i < view.size(); ++i) {
+            const EventRecord& r = view[i];
+            switch (static_cast<EventKind>(r.kind)) {
+                case EventKind::Message: messages_.admit(r.time, {r.id, 0}); break;
+                case EventKind::Reaction: reactions_.admit(r.time, {r.id, r.actor}); break;
+                case EventKind::Channel:
+                    if (r.channel >= channel_names_.size()) {
+                        channel_names_.resize(r.channel + 1);
+                    }
+                    channel_names_[r.channel] = std::string(view.text(r));
+                    channel_index_[r.id] = r.channel;
+                    break;
+                case EventKind::User:
+                    users_[r.id] = {std::hash<std::string_view>{}(view.text(r)), r.actor};
+                    break;
+            }
+        }
+        messages_.settle();
+        reactions_.settle();
+        return true;
+    }
+
+    std::optional<uint16_t> intern_channel(long long channel_id, std::string_view name, int64_t time) {
+        auto it = channel_index_.find(channel_id);
+        if (it == channel_index_.end()) {
+            if (channel_names_.size() >= kMaxLogChannels) {
+                return std::nullopt;
+            }
+            it = channel_index_.emplace(channel_id, static_cast<uint16_t>(channel_names_.size())).first;
+            channel_names_.emplace_back();
+        } else if (channel_names_[it->second] == name) {
+            return it->second;
+        }
+        channel_names_[it->second] = std::string(name);
+        push({channel_id, 0, time, 0, 0, it->second, static_cast<uint8_t>(EventKind::Channel), 0}, name);
+        return it->second;
+    }
+
+    void push(EventRecord record, std::string_view text) {
+        text = text.substr(0, kMaxEventText);
+        record.text = (text_size_ + pending_text_.size()) << 16 | text.size();
+        pending_text_.append(text.data(), text.size());
+        pending_.push_back(record);
+    }
+};
+
+// --replay: the dashboard as of any moment a log covers. Message and reaction
+// records are folded in time order, and the aggregates are saved every
+// `checkpoint_every_` of them, so a seek decodes the nearest checkpoint at or
+// before the target and folds only what follows it.
+class EventReplay {
+public:
+    static constexpr size_t kMinCheckpointEvents = 16384;
+    static constexpr size_t kMaxCheckpoints = 64;
+
+    bool open(const std::string& path, std::string& error) {
+        if (!log_.open(path, error)) {
+            return false;
+        }
+        for (size_t i = 0; i < log_.size(); ++i) {
+            const EventRecord& r = log_[i];
+            switch (static_cast<EventKind>(r.kind)) {
+                case EventKind::Message:
+                case EventKind::Reaction:
+                    events_.push_back(static_cast<uint32_t>(i));
+                    break;
+                case EventKind::Channel:
+                    if (r.channel >= channel_ids_.size()) {
+                        channel_ids_.resize(r.channel + 1, 0);
+                        channel_names_.resize(r.channel + 1);
+                    }
+                    channel_ids_[r.channel] = r.id;
+                    channel_names_[r.channel] = std::string(log_.text(r));
+                    break;
+                case EventKind::User:
+                    users_.push_back(static_cast<uint32_t>(i));
+                    break;
+            }
+        }
+        // A message whose channel record never made it into the log has no
+        // channel id to fold under; count it and leave it out.
+        const auto unresolved = std::remove_if(events_.begin(), events_.end(), [&](uint32_t i) {
+            const EventRecord& r = log_[i];
+            return static_cast<EventKind>(r.kind) == EventKind::Message && channel_id(r.channel) == 0;
+        });
+        dropped_ = static_cast<size_t>(events_.end() - unresolved);
+        events_.erase(unresolved, events_.end());
+        if (events_.empty()) {
+            error = path + ": no messages or reactions logged yet";
+            return false;
+        }
+        // Appends follow fetch order; stable, so ties keep it.
+        std::stable_sort(events_.begin(), events_.end(), [&](uint32_t a, uint32_t b) { return log_[a].time < log_[b].time; });
+
+        checkpoint_every_ = std::max(kMinCheckpointEvents, (events_.size() + kMaxCheckpoints - 1) / kMaxCheckpoints);
+        ActivityAggregator activity;
+        for (size_t pos = 0; pos < events_.size(); ++pos) {
+            if (pos % checkpoint_every_ == 0) {
+                BinaryWriter w;
+                activity.encode_to(w);
+                checkpoints_.push_back(w.data());
+            }
+            fold(pos, activity);
+        }
+        return true;
+    }
+
+    int64_t first_time() const { return log_[events_.front()].time; }
+    int64_t last_time() const { return log_[events_.back()].time; }
+    size_t event_count() const { return events_.size(); }
+    // Messages left out by open() for want of a logged channel.
+    size_t dropped_count() const { return dropped_; }
+
+    // `activity` as of `time`: every event at or before it.
+    void seek(int64_t time, ActivityAggregator& activity) const {
+        const size_t end = static_cast<size_t>(std::upper_bound(events_.begin(), events_.end(), time, [&](int64_t t, uint32_t i) {
+            return t < log_[i].time;
+        }) - events_.begin());
+        const size_t checkpoint = std::min(end / checkpoint_every_, checkpoints_.size() - 1);
+        BinaryReader r(checkpoints_[checkpoint].data(), checkpoints_[checkpoint].size());
+        activity.decode_from(r);
+        for (size_t pos = checkpoint * checkpoint_every_; pos < end; ++pos) {
+            fold(pos, activity);
+        }
+        activity.mark_synced();
+    }
+
+    // fn(channel_id, name) per channel, with its latest logged name.
+    template <typename Fn>
+    void for_each_channel(Fn fn) const {
+        for (size_t c = 0; c < channel_ids_.size(); ++c) {
+            if (channel_ids_[c] != 0) {
+                fn(channel_ids_[c], std::string_view(channel_names_[c]));
+            }
+        }
+    }
+
+    // fn(user_id, name, score) per user, by id, as they stood at `time`: the
+    // latest record not after it, or the first one for a user logged only later.
+    template <typename Fn>
+    void for_each_user_at(int64_t time, Fn fn) const {
+        std::unordered_map<long long, uint32_t> latest;
+        for (uint32_t i : users_) {
+            const EventRecord& r = log_[i];
+            auto [it, inserted] = latest.try_emplace(r.id, i);
+            if (!inserted && r.time <= time) {
+                it->second = i;
+            }
+        }
+        std::vector<std::pair<long long, uint32_t>> ordered(latest.begin(), latest.end());
+        std::sort(ordered.begin(), ordered.end());
+        for (const auto& [user_id, i] : ordered) {
+            fn(user_id, log_.text(log_[i]), static_cast<double>(log_[i].actor) / 100.0);
+        }
+    }
+
+    // For the benchmark corpus: the mapped log and its events in time order.
+    const EventLogView& log() const { return log_; }
+    const std::vector<uint32_t>& events() const { return events_; }
+    long long channel_id(uint16_t channel) const { return channel < channel_ids_.size() ? channel_ids_[channel] : 0; }
+
+private:
+    EventLogView log_;
+    std::vector<uint32_t> events_;  // Message / Reaction record indices by time
+    std::vector<uint32_t> users_;   // User record indices, in append (= time) order
+    std::vector<long long> channel_ids_;  // by log channel index
+    std::vector<std::string> channel_names_;
+    size_t checkpoint_every_ = kMinCheckpointEvents;
+    size_t dropped_ = 0;
+    std::vector<std::string> checkpoints_;  // encoded aggregates before events_[k * checkpoint_every_]
+
+    void fold(size_t pos, ActivityAggregator& activity) const {
+        const EventRecord& r = log_[events_[pos]];
+        const std::string timestamp = format_iso_utc(r.time);
+        std::optional<int> day;
+        if (r.day) {
+            day = r.day;
+        }
+        if (static_cast<EventKind>(r.kind) == EventKind::Message) {
+            const uint32_t channel = activity.intern_channel(channel_id(r.channel));
+            activity.fold_message(r.id, activity.intern_user(r.actor), channel,
+                                  static_cast<Category>(std::min<uint8_t>(r.category, static_cast<uint8_t>(Category::Misc))),
+                                  log_.text(r), timestamp, day);
+        } else {
+            activity.fold_reaction(r.id, r.actor, timestamp, day);
+        }
+    }
+};
+
+// --serve wire format. One response is
+//   u32 magic, u32 wire version, u64 epoch, u64 version, bool full,
+//   u32 n, n x (u8 section, str encoded section)
+// `epoch` identifies the serving process; `version` counts published snapshots
+// whose bytes changed. A delta carries only the sections that changed after
+// the client's version; a full response carries all of them.
+constexpr uint32_t kWireMagic = 0x57543043;  // "C0TW"
+constexpr uint32_t kWireVersion = 4;
+constexpr int kMaxLongPollSec = 30;
+// Long polls a --serve instance holds at once; each waits on a worker of its
+// own, and the next one is turned away with 503 instead of queueing.
+constexpr int kMaxSubscribers = 64;
+
+// Server half of --serve: keeps the latest encoded sections and when each last
+// changed, so any client version can be brought up to date without history.
+class SnapshotPublisher {
+public:
+    SnapshotPublisher() : epoch_(std::random_device{}() | (uint64_t{std::random_device{}()} << 32) | 1) {}
+
+    // Returns the number of sections that changed (0: nothing published).
+    size_t publish(const DashboardSnapshot& snap) {
+        std::array<std::string, kSnapshotSectionCount> encoded;
+        for (uint8_t section = 0; section < kSnapshotSectionCount; ++section) {
+            BinaryWriter w;
+            encode_section(w, snap, static_cast<SnapshotSection>(section));
+            encoded[section] = w.data();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t changed = 0;
+        for (uint8_t section = 0; section < kSnapshotSectionCount; ++section) {
+            if (version_ == 0 || encoded[section] != sections_[section].bytes) {
+                sections_[section] = {std::move(encoded[section]), version_ + 1};
+                ++changed;
+            }
+        }
+        if (changed) {
+            ++version_;
+            cv_.notify_all();
+        }
+        return changed;
+    }
+
+    uint64_t version() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return version_;
+    }
+
+    // Response for a client at (epoch, since). A client that is already current
+    // waits up to `wait_sec` for the next version before an empty reply.
+    std::string response(uint64_t epoch, uint64_t since, int wait_sec) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const bool same_epoch = epoch == epoch_ && since <= version_;
+        if (same_epoch && since == version_ && wait_sec > 0) {
+            cv_.wait_for(lock, std::chrono::seconds(wait_sec), [&]() { return stopping_ || version_ != since; });
+        }
+
+        const bool full = !same_epoch;
+        BinaryWriter w;
+        w.u32(kWireMagic);
+        w.u32(kWireVersion);
+        w.u64(epoch_);
+        w.u64(version_);
+        w.boolean(full);
+        uint32_t count = 0;
+        for (const Section& section : sections_) {
+            count += version_ > 0 && (full || section.changed_at > since);
+        }
+        w.u32(count);
+        for (uint8_t section = 0; section < kSnapshotSectionCount; ++section) {
+            if (version_ > 0 && (full || sections_[section].changed_at > since)) {
+                w.u8(section);
+                w.str(sections_[section].bytes);
+            }
+        }
+        return w.data();
+    }
+
+    // Releases long-polling requests so the server can shut down.
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        cv_.notify_all();
+    }
+
+private:
+    struct Section {
+        std::string bytes;
+        uint64_t changed_at = 0;
+    };
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    const uint64_t epoch_;
+    uint64_t version_ = 0;
+    std::array<Section, kSnapshotSectionCount> sections_;
+    bool stopping_ = false;
+};
+
+// GET /snapshot?epoch=E&since=V&wait=S for --serve, on its own thread pool.
+class SnapshotServer {
+public:
+    SnapshotServer() {
+        // Each waiting client holds a worker for up to kMaxLongPollSec; the spare
+        // ones answer immediate requests and the 503s while all are waiting.
+        server_.new_task_queue = [] { return new httplib::ThreadPool(kMaxSubscribers + 8); };
+        server_.Get("/snapshot", [this](const httplib::Request& req, httplib::Response& res) {
+            const uint64_t epoch = param_u64(req, "epoch");
+            const uint64_t since = param_u64(req, "since");
+            const int wait_sec = static_cast<int>(std::min<uint64_t>(param_u64(req, "wait"), kMaxLongPollSec));
+            if (wait_sec == 0) {
+                res.set_content(publisher_.response(epoch, since, 0), "application/octet-stream");
+                return;
+            }
+            if (waiting_.fetch_add(1) >= kMaxSubscribers) {
+                waiting_.fetch_sub(1);
+                res.status = 503;
+                res.set_header("Retry-After", std::to_string(kMaxLongPollSec));
+                res.set_content("too many subscribers\n", "text/plain");
+                return;
+            }
+            res.set_content(publisher_.response(epoch, since, wait_sec), "application/octet-stream");
+            waiting_.fetch_sub(1);
+            // A kept-alive connection would pin its worker between polls too.
+            res.set_header("Connection", "close");
+        });
+    }
+    ~SnapshotServer() { stop(); }
+    SnapshotServer(const SnapshotServer&) = delete;
+    SnapshotServer& operator=(const SnapshotServer&) = delete;
+
+    bool start(const std::string& host, int port, std::string& error) {
+        if (!server_.bind_to_port(host, port)) {
+            error = "cannot listen on " + host + ":" + std::to_string(port);
+            return false;
+        }
+        endpoint_ = host + ":" + std::to_string(port);
+        thread_ = std::thread([this]() { server_.listen_after_bind(); });
+        return true;
+    }
+
+    void stop() {
+        if (thread_.joinable()) {
+            publisher_.stop();
+            server_.stop();
+            thread_.join();
+        }
+    }
+
+    SnapshotPublisher& publisher() { return publisher_; }
+    const std::string& endpoint() const { return endpoint_; }
+
+private:
+    SnapshotPublisher publisher_;
+    httplib::Server server_;
+    std::thread thread_;
+    std::string endpoint_;
+    std::atomic<int> waiting_{0};  // long polls being held
+
+    static uint64_t param_u64(const httplib::Request& req, const char* name) {
+        const std::string value = req.get_param_value(name);
+        uint64_t out = 0;
+        std::from_chars(value.data(), value.data() + value.size(), out);
+        return out;
+    }
+};
+
+// Client half (--upstream URL): long-polls a --serve instance and rebuilds the
+// snapshot from the sections it holds. Used by the refresh worker in place of
+// load_snapshot, so the UI path is unchanged.
+class UpstreamClient {
+public:
+    enum class Poll {
+        Updated,
+        Unchanged,
+        Failed
+    };
+
+    explicit UpstreamClient(const std::string& url) : url_(url), http_(url) {
+        // One connection per poll: the server frees the worker after each answer.
+        http_.set_keep_alive(false);
+        http_.set_connection_timeout(10);
+        http_.set_read_timeout(kMaxLongPollSec + 15);
+    }
+
+    const std::string& url() const { return url_; }
+
+    Poll poll(DashboardSnapshot& snap, std::string& error) {
+        const PerfClock::time_point start = PerfClock::now();
+        const httplib::Params params = {
+            {"epoch", std::to_string(epoch_)},
+            {"since", std::to_string(version_)},
+            {"wait", std::to_string(version_ ? kMaxLongPollSec : 0)}
+        };
+        const httplib::Result res = http_.Get("/snapshot", params, httplib::Headers{});
+        const size_t bytes = res ? res->body.size() : 0;
+        auto finish = [&](Poll result) {
+            perf_stats().record_query("upstream /snapshot", elapsed_us(start), bytes, 0, result != Poll::Failed, result == Poll::Unchanged);
+            return result;
+        };
+        if (!res) {
+            error = "upstream " + url_ + ": " + httplib::to_string(res.error());
+            return finish(Poll::Failed);
+        }
+        if (res->status != 200) {
+            error = "upstream " + url_ + ": HTTP " + std::to_string(res->status) +
+                    (res->status == 503 ? " (subscriber limit reached)" : "");
+            return finish(Poll::Failed);
+        }
+
+        BinaryReader r(res->body.data(), res->body.size());
+        if (r.u32() != kWireMagic || r.u32() != kWireVersion) {
+            error = "upstream " + url_ + ": not a comm0ns_tui --serve endpoint (or another version)";
+            return finish(Poll::Failed);
+        }
+        const uint64_t epoch = r.u64();
+        const uint64_t version = r.u64();
+        const bool full = r.boolean();
+        std::array<std::string, kSnapshotSectionCount> sections;
+        if (!full) {
+            sections = sections_;
+        }
+        const uint32_t count = r.count();
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint8_t section = r.u8();
+            std::string bytes = r.str();
+            if (section < kSnapshotSectionCount) {
+                sections[section] = std::move(bytes);
+            }
+        }
+        if (!r.ok()) {
+            error = "upstream " + url_ + ": truncated response";
+            return finish(Poll::Failed);
+        }
+        const bool changed = epoch != epoch_ || version != version_;
+        epoch_ = epoch;
+        version_ = version;
+        sections_ = std::move(sections);
+        if (!changed || version == 0) {
+            return finish(Poll::Unchanged);
+        }
+
+        // Sections are self-delimiting, so decoding them back to back is the
+        // cache layout.
+        std::string joined;
+        for (const std::string& section : sections_) {
+            joined += section;
+        }
+        BinaryReader all(joined.data(), joined.size());
+        decode(all, snap);
+        if (!all.ok()) {
+            epoch_ = 0;  // resync from a full response
+            error = "upstream " + url_ + ": incomplete snapshot";
+            return finish(Poll::Failed);
+        }
+        return finish(Poll::Updated);
+    }
+
+    // Safe from any thread: aborts a long poll in flight.
+    void cancel() { http_.stop(); }
+
+private:
+    std::string url_;
+    httplib::Client http_;
+    uint64_t epoch_ = 0;
+    uint64_t version_ = 0;
+    std::array<std::string, kSnapshotSectionCount> sections_;
+};
+
+// Realtime sends a heartbeat reply at this period, so a read that stays silent
+// for two of them means the socket is dead.
+constexpr int kRealtimeHeartbeatSec = 25;
+constexpr int kRealtimeMaxBackoffSec = 60;
+
+// httplib offers no way to interrupt a WebSocketClient::read() short of the
+// peer answering. Naming the private socket in an explicit instantiation is
+// exempt from access checks, which lets stop() shut the socket down instead.
+struct WebSocketSocket {
+    using type = socket_t httplib::ws::WebSocketClient::*;
+    friend type member_of(WebSocketSocket);
+};
+
+template <typename Tag, typename Tag::type Member>
+struct ExposeMember {
+    friend typename Tag::type member_of(Tag) { return Member; }
+};
+
+template struct ExposeMember<WebSocketSocket, &httplib::ws::WebSocketClient::sock_>;
+
+// --realtime: INSERTs on messages/reactions pushed by Supabase Realtime
+// (Postgres changes over the Phoenix channel protocol at
+// $SUPABASE_URL/realtime/v1/websocket). Each record is projected into a
+// QueryResult shaped like the polled pages, queued until the refresh worker
+// take()s it. The socket lives on its own thread and reconnects with backoff;
+// live() is false whenever inserts may be going unseen.
+class RealtimeFeed {
+public:
+    enum class Event {
+        Rows,    // take() has something
+        Joined   // (re)subscribed: inserts from before this were not pushed
+    };
+
+    RealtimeFeed(const std::vector<QueryField>& message_fields, const std::vector<QueryField>& reaction_fields,
+                 std::function<void(Event)> notify)
+        : message_fields_(message_fields),
+          reaction_fields_(reaction_fields),
+          notify_(std::move(notify)),
+          messages_(message_fields),
+          reactions_(reaction_fields) {
+        std::string url = env_or_empty("SUPABASE_URL");
+        const std::string key = env_or_empty("SUPABASE_KEY");
+        while (!url.empty() && url.back() == '/') {
+            url.pop_back();
+        }
+        token_ = env_or_empty("SUPABASE_AUTH_TOKEN");
+        if (token_.empty()) {
+            token_ = key;
+        }
+        // An https URL the native client cannot open (no OpenSSL) cannot be
+        // upgraded to wss either.
+        if (url.empty() || key.empty() || !httplib::Client(url).is_valid()) {
+            error_ = "realtime needs SUPABASE_URL / SUPABASE_KEY and, for https, an OpenSSL build";
+            return;
+        }
+        const size_t scheme_end = url.find("://");
+        url_ = (url.compare(0, scheme_end, "https") == 0 ? "wss" : "ws") + url.substr(scheme_end) +
+               "/realtime/v1/websocket?apikey=" + httplib::encode_uri_component(key) + "&vsn=1.0.0";
+        thread_ = std::thread([this]() { run(); });
+        heartbeat_ = std::thread([this]() { heartbeat_loop(); });
+    }
+
+    ~RealtimeFeed() { stop(); }
+
+    RealtimeFeed(const RealtimeFeed&) = delete;
+    RealtimeFeed& operator=(const RealtimeFeed&) = delete;
+
+    bool live() const { return live_; }
+    // Successful subscriptions so far; a change means a gap to backfill.
+    uint64_t joins() const { return joins_; }
+
+    std::string error() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+    // Hands over everything queued since the last call.
+    void take(QueryResult& messages, QueryResult& reactions) {
+        QueryResult fresh_messages(message_fields_);
+        QueryResult fresh_reactions(reaction_fields_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages = std::exchange(messages_, std::move(fresh_messages));
+        reactions = std::exchange(reactions_, std::move(fresh_reactions));
+    }
+
+    // Leaves the channel, then shuts the socket down so the reader wakes now
+    // rather than after a reply that a half-dead connection may never bring.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) {
+                return;
+            }
+            stop_ = true;
+            if (ws_) {
+                ws_->send(message(kTopic, "phx_leave", nlohmann::json::object()));
+                const socket_t sock = ws_->*member_of(WebSocketSocket{});
+                if (sock != INVALID_SOCKET) {
+                    httplib::detail::shutdown_socket(sock);
+                }
+            }
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (heartbeat_.joinable()) {
+            heartbeat_.join();
+        }
+    }
+
+private:
+    static constexpr const char* kTopic = "realtime:comm0ns";
+
+    std::vector<QueryField> message_fields_;
+    std::vector<QueryField> reaction_fields_;
+    std::function<void(Event)> notify_;
+    std::string url_;
+    std::string token_;
+    std::thread thread_;
+    std::thread heartbeat_;
+    std::atomic<bool> live_{false};
+    std::atomic<uint64_t> joins_{0};
+    std::atomic<uint64_t> next_ref_{1};
+
+    mutable std::mutex mutex_;  // guards everything below
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::string error_;
+    httplib::ws::WebSocketClient* ws_ = nullptr;  // owned by run(); set while connected
+    QueryResult messages_;
+    QueryResult reactions_;
+
+    std::string message(const std::string& topic, const char* event, nlohmann::json payload) {
+        return message(topic, event, std::move(payload), std::to_string(next_ref_++));
+    }
+
+    static std::string message(const std::string& topic, const char* event, nlohmann::json payload, const std::string& ref) {
+        return nlohmann::json{{"topic", topic}, {"event", event}, {"payload", std::move(payload)}, {"ref", ref}}.dump();
+    }
+
+    static std::string string_at(const nlohmann::json& object, const char* key) {
+        auto it = object.find(key);
+        return it != object.end() && it->is_string() ? it->get<std::string>() : std::string();
+    }
+
+    void run() {
+        int backoff_sec = 1;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            lock.unlock();
+            std::string error;
+            const bool joined = session(error);
+            live_ = false;
+            lock.lock();
+            if (stop_) {
+                break;
+            }
+            error_ = error;
+            backoff_sec = joined ? 1 : std::min(backoff_sec * 2, kRealtimeMaxBackoffSec);
+            cv_.wait_for(lock, std::chrono::seconds(backoff_sec), [this]() { return stop_; });
+        }
+    }
+
+    // One connection, from connect to close. True if the channel was joined.
+    bool session(std::string& error) {
+        httplib::ws::WebSocketClient ws(url_);
+        ws.set_read_timeout(2 * kRealtimeHeartbeatSec);
+        if (!ws.connect()) {
+            error = "realtime: cannot connect to " + url_.substr(0, url_.find('?'));
+            return false;
+        }
+        const std::string join_ref = std::to_string(next_ref_++);
+        const std::string join = message(kTopic, "phx_join", {
+            {"config", {
+                {"broadcast", {{"self", false}}},
+                {"presence", {{"key", ""}}},
+                {"postgres_changes", {
+                    {{"event", "INSERT"}, {"schema", "public"}, {"table", "messages"}},
+                    {{"event", "INSERT"}, {"schema", "public"}, {"table", "reactions"}}
+                }}
+            }},
+            {"access_token", token_}
+        }, join_ref);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_ || !ws.send(join)) {
+                return false;
+            }
+            ws_ = &ws;
+        }
+
+        bool joined = false;
+        std::string frame;
+        while (ws.read(frame) != httplib::ws::ReadResult::Fail) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop_) {
+                    break;
+                }
+            }
+            if (!handle(frame, join_ref, joined, error)) {
+                break;
+            }
+        }
+        if (joined && error.empty()) {
+            error = "realtime: connection closed";
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ws_ = nullptr;
+        }
+        if (ws.is_open()) {
+            ws.close();
+        }
+        return joined;
+    }
+
+    // False ends the session.
+    bool handle(const std::string& frame, const std::string& join_ref, bool& joined, std::string& error) {
+        const PerfClock::time_point start = PerfClock::now();
+        const nlohmann::json msg = nlohmann::json::parse(frame, nullptr, false);
+        if (msg.is_discarded() || !msg.is_object() || string_at(msg, "topic") != kTopic) {
+            return true;  // heartbeat replies come back on "phoenix"
+        }
+        static const nlohmann::json kEmpty = nlohmann::json::object();
+        const std::string event = string_at(msg, "event");
+        auto payload_it = msg.find("payload");
+        const nlohmann::json& payload = payload_it != msg.end() && payload_it->is_object() ? *payload_it : kEmpty;
+
+        if (event == "phx_reply" && string_at(msg, "ref") == join_ref) {
+            if (string_at(payload, "status") != "ok") {
+                error = "realtime: join rejected: " + payload.dump();
+                return false;
+            }
+            joined = true;
+            live_ = true;
+            ++joins_;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                error_.clear();
+            }
+            notify_(Event::Joined);
+            return true;
+        }
+        if (event == "system" && string_at(payload, "status") == "error") {
+            error = "realtime: " + string_at(payload, "message");
+            return false;
+        }
+        if (event == "phx_error" || event == "phx_close") {
+            error = "realtime: channel " + event;
+            return false;
+        }
+        if (event != "postgres_changes") {
+            return true;
+        }
+
+        auto data = payload.find("data");
+        if (data == payload.end() || !data->is_object() || string_at(*data, "type") != "INSERT") {
+            return true;
+        }
+        auto record = data->find("record");
+        const std::string table = string_at(*data, "table");
+        if (record == data->end() || (table != "messages" && table != "reactions")) {
+            return true;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (table == "messages") {
+                project_json_row(messages_, *record, message_fields_);
+            } else {
+                project_json_row(reactions_, *record, reaction_fields_);
+            }
+        }
+        perf_stats().record_query("realtime " + table, elapsed_us(start), frame.size(), 1, true);
+        notify_(Event::Rows);
+        return true;
+    }
+
+    void heartbeat_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            cv_.wait_for(lock, std::chrono::seconds(kRealtimeHeartbeatSec), [this]() { return stop_; });
+            if (!stop_ && ws_) {
+                ws_->send(message("phoenix", "heartbeat", nlohmann::json::object()));
+            }
+        }
+    }
+};
+
+// A Stage2 verdict, cached per message so each one is classified once. The
+// file is a header and then these records in append order; `time` and the
+// ids let a rollup-seeded sync apply verdicts for rows it never downloads.
+struct Stage2Record {
+    int64_t message_id;
+    int64_t user_id;
+    int64_t channel_id;
+    int64_t time;         // epoch seconds of the message
+    uint8_t category;     // Category
+    uint8_t confidence;   // percent
+    uint8_t reserved[6];
+
+    Category verdict() const {
+        return static_cast<Category>(std::min<uint8_t>(category, static_cast<uint8_t>(Category::Misc)));
+    }
+};
+static_assert(sizeof(Stage2Record) == 40, "Stage2Record is the on-disk layout");
+
+constexpr uint32_t kStage2CacheMagic = 0x32543043;  // "C0T2"
+constexpr uint32_t kStage2CacheVersion = 1;
+constexpr size_t kStage2CacheHeader = 8;  // u32 magic, u32 version
+
+// Owned by the refresh worker. Verdicts are appended on flush(); a torn
+// trailing record is ignored on load and overwritten by the next append.
+class Stage2Cache {
+public:
+    ~Stage2Cache() { close(); }
+
+    // One cache per SUPABASE_URL in the cache directory; empty without one.
+    static std::string default_path() {
+        const std::string dir = cache_dir();
+        if (dir.empty()) {
+            return {};
+        }
+        char name[40];
+        std::snprintf(name, sizeof(name), "/stage2-%016llx.bin",
+                      static_cast<unsigned long long>(std::hash<std::string>{}(env_or_empty("SUPABASE_URL"))));
+        return dir + name;
+    }
+
+    // Loads the verdicts at `path` and continues the file. Another format there
+    // leaves the cache in memory only rather than clobbering it.
+    void open(const std::string& path) {
+        close();
+        if (path.empty()) {
+            return;
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        // A second instance on the same cache (a TUI next to --serve) would cut
+        // off the other's appends: only the first one to lock the file writes
+        // it, and the other keeps its new verdicts in memory.
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ >= 0 && ::flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+            close();
+        }
+        MappedFile file;
+        size_t whole = 0;
+        if (file.open(path) && file.size() > 0) {
+            uint32_t header[2] = {0, 0};
+            if (file.size() >= kStage2CacheHeader) {
+                std::memcpy(header, file.data(), sizeof(header));
+            }
+            if (header[0] != kStage2CacheMagic || header[1] != kStage2CacheVersion) {
+                close();
+                return;
+            }
+            const size_t count = (file.size() - kStage2CacheHeader) / sizeof(Stage2Record);
+            const Stage2Record* records = reinterpret_cast<const Stage2Record*>(file.data() + kStage2CacheHeader);
+            records_.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                records_[records[i].message_id] = records[i];
+            }
+            whole = kStage2CacheHeader + count * sizeof(Stage2Record);
+        }
+        if (fd_ < 0) {
+            return;
+        }
+        if (::ftruncate(fd_, static_cast<off_t>(whole)) != 0) {
+            close();
+            return;
+        }
+        if (whole == 0) {
+            const uint32_t header[2] = {kStage2CacheMagic, kStage2CacheVersion};
+            if (!write_all(fd_, header, sizeof(header))) {
+                close();
+            }
+        }
+    }
+
+    const Stage2Record* find(long long message_id) const {
+        auto it = records_.find(message_id);
+        return it != records_.end() ? &it->second : nullptr;
+    }
+
+    void add(const Stage2Record& record) {
+        records_[record.message_id] = record;
+        if (fd_ >= 0) {
+            pending_.push_back(record);
+        }
+    }
+
+    void flush() {
+        if (fd_ < 0 || pending_.empty()) {
+            return;
+        }
+        if (!write_all(fd_, pending_.data(), pending_.size() * sizeof(Stage2Record))) {
+            close();  // keeps classifying; verdicts from here on are not persisted
+        }
+        pending_.clear();
+    }
+
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& [id, record] : records_) {
+            fn(record);
+        }
+    }
+
+private:
+    int fd_ = -1;
+    std::unordered_map<long long, Stage2Record> records_;
+    std::vector<Stage2Record> pending_;
+
+    void close() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        pending_.clear();
+    }
+};
+
+// A Misc message waiting for Stage2; `channel` is its label, sent as context.
+struct Stage2Item {
+    long long message_id;
+    long long user_id;
+    long long channel_id;
+    long long time;
+    std::string channel;
+    std::string content;
+};
+
+constexpr size_t kStage2Batch = 32;
+constexpr int kStage2Concurrency = 2;
+constexpr size_t kStage2MaxQueued = 20000;
+constexpr int kStage2MaxBackoffSec = 60;
+
+// Stage2 for the messages Stage1 leaves Misc, on $COMM0NS_TUI_STAGE2_URL:
+// POST {"messages":[{"id","channel","content"}]} answered by
+// {"results":[{"id","category","confidence"}]} (or the bare array), with
+// "category" one of info/insight/vibe/ops/misc and "confidence" in 0..1.
+// kStage2Concurrency workers, each on its own connection, send batches of up
+// to kStage2Batch, newest first; a failed batch is queued again and the
+// worker backs off. Past kStage2MaxQueued the oldest waiting messages are
+// dropped. Verdicts are held until the refresh worker take()s them.
+class Stage2Classifier {
+public:
+    Stage2Classifier(const std::string& url, std::function<void()> notify) : notify_(std::move(notify)) {
+        const size_t scheme_end = url.find("://");
+        const size_t path_start = url.find('/', scheme_end == std::string::npos ? 0 : scheme_end + 3);
+        base_url_ = url.substr(0, path_start);
+        path_ = path_start == std::string::npos ? "/" : url.substr(path_start);
+        const std::string token = env_or_empty("COMM0NS_TUI_STAGE2_TOKEN");
+        if (!token.empty()) {
+            headers_.emplace("Authorization", "Bearer " + token);
+        }
+        if (!httplib::Client(base_url_).is_valid()) {
+            return;  // https without OpenSSL: everything stays queued
+        }
+        for (int i = 0; i < kStage2Concurrency; ++i) {
+            workers_.emplace_back([this]() { run(); });
+        }
+    }
+
+    ~Stage2Classifier() { stop(); }
+
+    Stage2Classifier(const Stage2Classifier&) = delete;
+    Stage2Classifier& operator=(const Stage2Classifier&) = delete;
+
+    // Queues the items not already queued, in flight or waiting to be taken.
+    void submit(std::vector<Stage2Item>& items) {
+        if (items.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (Stage2Item& item : items) {
+                if (pending_.insert(item.message_id).second) {
+                    queue_.push_back(std::move(item));
+                }
+            }
+            while (queue_.size() > kStage2MaxQueued) {
+                pending_.erase(queue_.front().message_id);
+                queue_.pop_front();
+            }
+            backlog_ = queue_.size() + in_flight_;
+        }
+        items.clear();
+        cv_.notify_all();
+    }
+
+    // Hands over the verdicts returned since the last call.
+    std::vector<Stage2Record> take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const Stage2Record& record : done_) {
+            pending_.erase(record.message_id);
+        }
+        return std::exchange(done_, {});
+    }
+
+    // Messages queued or in flight.
+    size_t backlog() const { return backlog_; }
+
+    // Aborts the requests in flight; what is still queued is dropped.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) {
+                return;
+            }
+            stop_ = true;
+            for (httplib::Client* client : clients_) {
+                client->stop();
+            }
+        }
+        cv_.notify_all();
+        for (std::thread& worker : workers_) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+private:
+    std::string base_url_;
+    std::string path_;
+    httplib::Headers headers_;
+    std::function<void()> notify_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> backlog_{0};
+
+    mutable std::mutex mutex_;  // guards everything below
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::deque<Stage2Item> queue_;
+    size_t in_flight_ = 0;
+    std::unordered_set<long long> pending_;  // ids queued, in flight or in done_
+    std::vector<Stage2Record> done_;
+    std::vector<httplib::Client*> clients_;  // one per worker, for stop()
+
+    void run() {
+        httplib::Client http(base_url_);
+        http.set_keep_alive(true);
+        http.set_connection_timeout(10);
+        http.set_read_timeout(120);
+        int backoff_sec = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        clients_.push_back(&http);
+        while (true) {
+            cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (stop_) {
+                break;
+            }
+            std::vector<Stage2Item> batch;
+            while (batch.size() < kStage2Batch && !queue_.empty()) {
+                batch.push_back(std::move(queue_.back()));
+                queue_.pop_back();
+            }
+            in_flight_ += batch.size();
+            lock.unlock();
+
+            std::vector<Stage2Record> verdicts;
+            const bool ok = classify(http, batch, verdicts);
+
+            lock.lock();
+            in_flight_ -= batch.size();
+            if (ok) {
+                // Ids the answer left out are given up on until a resync offers them again.
+                for (const Stage2Item& item : batch) {
+                    pending_.erase(item.message_id);
+                }
+                for (const Stage2Record& record : verdicts) {
+                    pending_.insert(record.message_id);
+                    done_.push_back(record);
+                }
+                backoff_sec = 0;
+            } else {
+                for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+                    queue_.push_back(std::move(*it));
+                }
+            }
+            backlog_ = queue_.size() + in_flight_;
+            if (ok && !verdicts.empty()) {
+                lock.unlock();
+                notify_();
+                lock.lock();
+            } else if (!ok) {
+                backoff_sec = std::min(std::max(1, backoff_sec * 2), kStage2MaxBackoffSec);
+                cv_.wait_for(lock, std::chrono::seconds(backoff_sec), [this]() { return stop_; });
+            }
+        }
+        clients_.erase(std::find(clients_.begin(), clients_.end(), &http));
+    }
+
+    // False when the batch should be retried; failures show on the Perf page.
+    bool classify(httplib::Client& http, const std::vector<Stage2Item>& batch, std::vector<Stage2Record>& verdicts) {
+        const PerfClock::time_point start = PerfClock::now();
+        nlohmann::json messages = nlohmann::json::array();
+        std::unordered_map<long long, const Stage2Item*> by_id;
+        for (const Stage2Item& item : batch) {
+            messages.push_back({{"id", std::to_string(item.message_id)}, {"channel", item.channel}, {"content", item.content}});
+            by_id.emplace(item.message_id, &item);
+        }
+        // Content is whatever Discord stored; invalid UTF-8 must not throw here.
+        const std::string body = nlohmann::json{{"messages", std::move(messages)}}.dump(
+            -1, ' ', false, nlohmann::json::error_handler_t::replace);
+        const httplib::Result res = http.Post(path_, headers_, body, "application/json");
+        const size_t bytes = res ? res->body.size() : 0;
+        auto finish = [&](bool ok) {
+            perf_stats().record_query("stage2", elapsed_us(start), bytes, verdicts.size(), ok);
+            return ok;
+        };
+        if (!res || res->status != 200) {
+            return finish(false);
+        }
+        const nlohmann::json answer = nlohmann::json::parse(res->body, nullptr, false);
+        const nlohmann::json* results = &answer;
+        if (answer.is_object() && answer.contains("results")) {
+            results = &answer["results"];
+        }
+        if (!results->is_array()) {
+            return finish(false);
+        }
+        for (const nlohmann::json& result : *results) {
+            if (!result.is_object()) {
+                continue;
+            }
+            const auto id_it = result.find("id");
+            const auto category_it = result.find("category");
+            if (id_it == result.end() || category_it == result.end() || !category_it->is_string()) {
+                continue;
+            }
+            const long long id = id_it->is_string() ? parse_ll(id_it->get<std::string>())
+                               : id_it->is_number_integer() ? id_it->get<long long>() : 0;
+            auto item_it = by_id.find(id);
+            const std::optional<Category> category = parse_category(category_it->get<std::string>());
+            if (item_it == by_id.end() || !category) {
+                continue;
+            }
+            const auto confidence_it = result.find("confidence");
+            const double confidence = confidence_it != result.end() && confidence_it->is_number()
+                ? confidence_it->get<double>() : 1.0;
+            const Stage2Item& item = *item_it->second;
+            Stage2Record record{};
+            record.message_id = item.message_id;
+            record.user_id = item.user_id;
+            record.channel_id = item.channel_id;
+            record.time = item.time;
+            record.category = static_cast<uint8_t>(*category);
+            record.confidence = static_cast<uint8_t>(std::lround(std::clamp(confidence, 0.0, 1.0) * 100.0));
+            verdicts.push_back(record);
+            by_id.erase(item_it);
+        }
+        return finish(true);
+    }
+
+    static std::optional<Category> parse_category(std::string_view name) {
+        for (size_t c = 0; c < kCategoryCount; ++c) {
+            if (equals_ascii_ci(name, category_name(static_cast<Category>(c)))) {
+                return static_cast<Category>(c);
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+// One user's latest messages and reactions, fetched when the Members page
+// selects them.
+struct MemberActivity {
+    struct Post {
+        std::string channel;  // label
+        std::string content;
+        std::string timestamp;
+    };
+    bool ok = false;
+    std::vector<Post> messages;        // newest first
+    std::vector<std::string> reacted;  // created_at of the user's latest reactions, newest first
+    std::chrono::steady_clock::time_point fetched_at;
+};
+
+// Targeted messages/reactions queries for the member detail panel, on a
+// thread and connections of its own, so they never wait behind a poll. Only
+// the latest request is kept: scrolling through the table asks once for the
+// row it stops on. Results are cached per user for kTtlSec, up to kMaxCached;
+// a failed fetch is retried after kRetrySec.
+class MemberActivityFetcher {
+public:
+    static constexpr int kRows = 8;
+    static constexpr int kTtlSec = 60;
+    static constexpr int kRetrySec = 10;
+    static constexpr size_t kMaxCached = 256;
+
+    explicit MemberActivityFetcher(std::function<void()> notify) : notify_(std::move(notify)) {
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    ~MemberActivityFetcher() { stop(); }
+
+    MemberActivityFetcher(const MemberActivityFetcher&) = delete;
+    MemberActivityFetcher& operator=(const MemberActivityFetcher&) = delete;
+
+    // UI thread. A no-op while a fresh result is cached, a failed one is
+    // waiting out kRetrySec, or the same user is in flight.
+    void request(long long user_id) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (user_id == 0 || user_id == in_flight_ || user_id == wanted_) {
+                return;
+            }
+            auto it = cache_.find(user_id);
+            if (it != cache_.end() && std::chrono::steady_clock::now() - it->second.fetched_at <
+                                          std::chrono::seconds(it->second.ok ? kTtlSec : kRetrySec)) {
+                return;
+            }
+            wanted_ = user_id;
+        }
+        cv_.notify_all();
+    }
+
+    // The cached result (possibly stale), or nullptr before the first one
+    // lands. Valid until the next call on the UI thread.
+    const MemberActivity* find(long long user_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = cache_.find(user_id);
+        if (it == cache_.end()) {
+            return nullptr;
+        }
+        shown_ = it->second;
+        return &shown_;
+    }
+
+    // Bumped whenever a result lands.
+    uint64_t generation() const { return generation_; }
+
+    // Refresh worker: channel labels by id, as of the last poll.
+    void set_channel_labels(const std::unordered_map<long long, std::string>& labels) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        channel_labels_ = labels;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) {
+                return;
+            }
+            stop_ = true;
+        }
+        pool_.cancel();
+        cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+private:
+    std::function<void()> notify_;
+    SupabaseFetchPool pool_;
+    std::thread thread_;
+    std::atomic<uint64_t> generation_{0};
+    MemberActivity shown_;  // UI thread's copy
+
+    std::mutex mutex_;  // guards everything below
+    std::condition_variable cv_;
+    bool stop_ = false;
+    long long wanted_ = 0;
+    long long in_flight_ = 0;
+    std::unordered_map<long long, MemberActivity> cache_;
+    std::unordered_map<long long, std::string> channel_labels_;
+
+    static std::vector<QuerySpec> specs_for(long long user_id) {
+        const std::string user = "user_id=eq." + std::to_string(user_id);
+        const std::string limit = "limit=" + std::to_string(kRows);
+        std::vector<QuerySpec> specs(2);
+        specs[0].endpoint = "messages";
+        specs[0].params = {"select=channel_id,content,timestamp", user, "order=timestamp.desc", limit};
+        specs[0].fields = {{{"channel_id"}, "", FieldType::Int}, {{"content"}, ""}, {{"timestamp"}, ""}};
+        specs[1].endpoint = "reactions";
+        specs[1].params = {"select=created_at", user, "order=created_at.desc", limit};
+        specs[1].fields = {{{"created_at"}, ""}};
+        return specs;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this]() { return stop_ || wanted_ != 0; });
+            if (stop_) {
+                break;
+            }
+            in_flight_ = std::exchange(wanted_, 0);
+            lock.unlock();
+
+            const std::vector<QueryResult> results = pool_.fetch_all(specs_for(in_flight_));
+            MemberActivity activity;
+            activity.ok = results[0].ok && results[1].ok;
+            activity.fetched_at = std::chrono::steady_clock::now();
+            for (size_t row = 0; row < results[1].size(); ++row) {
+                activity.reacted.emplace_back(results[1].text(row, 0));
+            }
+
+            lock.lock();
+            for (size_t row = 0; row < results[0].size(); ++row) {
+                const long long channel_id = results[0].integer(row, 0);
+                auto label_it = channel_labels_.find(channel_id);
+                activity.messages.push_back({label_it != channel_labels_.end() ? label_it->second : normalize_channel_label("", channel_id),
+                                             std::string(results[0].text(row, 1)), std::string(results[0].text(row, 2))});
+            }
+            if (stop_) {
+                break;
+            }
+            // A failed fetch keeps the last good result, marked failed; its
+            // fetched_at then holds the next request off for kRetrySec.
+            auto [it, inserted] = cache_.try_emplace(in_flight_);
+            if (activity.ok || inserted) {
+                it->second = std::move(activity);
+            } else {
+                it->second.ok = false;
+                it->second.fetched_at = activity.fetched_at;
+            }
+            in_flight_ = 0;
+            while (cache_.size() > kMaxCached) {
+                cache_.erase(std::min_element(cache_.begin(), cache_.end(), [](const auto& a, const auto& b) {
+                    return a.second.fetched_at < b.second.fetched_at;
+                }));
+            }
+            ++generation_;
+            lock.unlock();
+            notify_();
+            lock.lock();
+        }
+    }
+};
+
+struct RefreshOutcome {
+    std::unique_ptr<DashboardSnapshot> snapshot;  // null on failure
+    std::string error;
+    bool missing_credentials = false;
+    bool unchanged = false;  // upstream long poll ended with nothing newer
+};
+
+// Set by SIGINT/SIGTERM in --serve mode; the loop notices within a second.
+volatile std::sig_atomic_t g_stop_requested = 0;
+
+void on_stop_signal(int) {
+    g_stop_requested = 1;
+}
+
+// Page N (1-6, as the number keys select it) as a bit in a set of pages.
+constexpr unsigned page_bit(int page) {
+    return 1u << page;
+}
+
+class DashboardApp {
+    friend class PipelineBench;
+
+public:
+    struct TabHit {
+        int x0;
+        int x1;
+        int page;
+    };
+
+    struct MemberRowHit {
+        int y;
+        int x0;
+        int x1;
+        int row_index;
+    };
+
+    struct ChannelRangeHit {
+        int y;
+        int x0;
+        int x1;
+        ChannelActivityRange range;
+    };
 
-    DashboardApp() : rng_(std::random_device{}()) {
+    // With `upstream_url` the worker follows a --serve instance instead of
+    // querying Supabase; with `realtime` it takes messages/reactions from the
+    // Realtime feed and polls only the rest. With `replay` there is no worker:
+    // the dashboard shows the log as of a moment the keys move.
+    explicit DashboardApp(const std::string& upstream_url = {}, bool realtime = false,
+                          std::unique_ptr<EventReplay> replay = nullptr)
+        : rng_(std::random_device{}()) {
+        if (replay) {
+            replay_ = std::move(replay);
+        } else if (!upstream_url.empty()) {
+            upstream_ = std::make_unique<UpstreamClient>(upstream_url);
+        } else {
+            if (realtime) {
+                realtime_ = std::make_unique<RealtimeFeed>(messages_spec("").fields, reactions_spec("").fields,
+                                                           [this](RealtimeFeed::Event event) { on_realtime_event(event); });
+            }
+            event_log_.open(EventLog::default_path());
+            // Without credentials every fetch would fail; the panel goes without.
+            if (!env_or_empty("SUPABASE_URL").empty() && !env_or_empty("SUPABASE_KEY").empty()) {
+                member_activity_ = std::make_unique<MemberActivityFetcher>([this]() { wake_ui(); });
+            }
+            const std::string stage2_url = env_or_empty("COMM0NS_TUI_STAGE2_URL");
+            if (!stage2_url.empty()) {
+                stage2_cache_.open(Stage2Cache::default_path());
+                stage2_ = std::make_unique<Stage2Classifier>(stage2_url, [this]() { on_stage2_verdicts(); });
+            }
+        }
         init_empty_state();
         // Mock seed is intentionally disabled.
         // init_mock_data();
         // init_mock_histories();
-        refresh_from_db(false);
+        data_status_ = "DB LOADING";
+        if (replay_) {
+            data_status_ = "REPLAY";
+            seek_replay(replay_->last_time());
+        } else {
+            // Paint the last good snapshot instantly; the worker then syncs deltas
+            // on top of the restored aggregates.
+            DashboardSnapshot cached;
+            if (snapshot_cache_.load(cached, activity_)) {
+                apply_snapshot(cached);
+                showing_cache_ = true;
+                data_status_ = "CACHED";
+            }
+        }
+        if (pipe(wake_pipe_.data()) == 0) {
+            for (int fd : wake_pipe_) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+        } else {
+            wake_pipe_ = {-1, -1};
+        }
+        if (!replay_) {
+            start_refresh_worker();
+        }
+    }
+
+    ~DashboardApp() {
+        stop_refresh_worker();
+        for (int fd : wake_pipe_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    DashboardApp(const DashboardApp&) = delete;
+    DashboardApp& operator=(const DashboardApp&) = delete;
+
+    // Shown in the top bar while the --metrics-listen endpoint is serving.
+    void set_metrics_endpoint(const std::string& endpoint) {
+        const size_t colon = endpoint.rfind(':');
+        metrics_label_ = endpoint.empty() ? std::string() : "metrics:" + endpoint.substr(colon == std::string::npos ? 0 : colon + 1);
+    }
+
+    // --serve: no terminal. Refreshes are adopted exactly as the UI does, then
+    // published; the cached snapshot goes out first so clients paint at once.
+    void serve(SnapshotServer& server) {
+        // Clients may be on any page. The worker may have started its first load
+        // already; what it left out is then prefetched right after.
+        visible_pages_ = kAllPages;
+        std::signal(SIGINT, on_stop_signal);
+        std::signal(SIGTERM, on_stop_signal);
+        long long seen_generation = -1;
+        std::string realtime_error;
+        while (!g_stop_requested) {
+            adopt_refresh_outcome();
+            if (realtime_ && realtime_->error() != realtime_error) {
+                realtime_error = realtime_->error();
+                if (!realtime_error.empty()) {
+                    std::fprintf(stderr, "%s %s\n", now_hms().c_str(), realtime_error.c_str());
+                }
+            }
+            if (seen_generation != data_generation_) {
+                seen_generation = data_generation_;
+                if (db_ready_) {
+                    const size_t changed = server.publisher().publish(current_snapshot());
+                    std::fprintf(stderr, "%s %s v%llu (%zu/%zu sections changed)\n", now_hms().c_str(), data_status_.c_str(),
+                                 static_cast<unsigned long long>(server.publisher().version()), changed,
+                                 static_cast<size_t>(kSnapshotSectionCount));
+                }
+                if (!last_error_.empty()) {
+                    std::fprintf(stderr, "%s %s: %s\n", now_hms().c_str(), data_status_.c_str(), last_error_.c_str());
+                }
+            }
+            wait_for_event();
+        }
     }
 
     void run() {
@@ -688,6 +5952,7 @@ public:
         cbreak();
         noecho();
         keypad(stdscr, TRUE);
+        set_escdelay(25);  // Esc closes the Members prompt
         nodelay(stdscr, TRUE);
         curs_set(0);
         mousemask(ALL_MOUSE_EVENTS, nullptr);
@@ -730,26 +5995,22 @@ public:
                 last_tick = now;
             }
 
+            adopt_refresh_outcome();
+            follow_member_activity();
             draw();
+            wait_for_event();
 
-            int ch = getch();
-            if (ch != ERR) {
+            int ch = ERR;
+            while (running && (ch = getch()) != ERR) {
                 handle_key(ch, running);
             }
-
-            napms(30);
         }
 
+        destroy_panels();
         endwin();
     }
 
 private:
-    struct QueryResult {
-        bool ok = false;
-        std::vector<std::vector<std::string>> rows;
-        std::string error;
-    };
-
     std::vector<Member> members_;
     std::vector<Channel> channels_;
     std::vector<Vote> votes_;
@@ -758,26 +6019,52 @@ private:
     std::vector<MessageSample> samples_;
     Sprint sprint_;
 
-    std::vector<int> total_hist_;
-    std::vector<int> info_hist_;
-    std::vector<int> insight_hist_;
-    std::vector<int> vibe_hist_;
-    std::vector<int> ops_hist_;
+    ActivitySeries series_;
+    std::vector<std::pair<int, int>> daily_pulse_;
+
+    // Governance what-if: weight overrides by channel label (kept across
+    // refreshes), rescored into what_if_scores_ whenever either side changes.
+    ScoringBasis scoring_;
+    bool what_if_active_ = false;
+    size_t what_if_channel_ = 0;
+    std::unordered_map<std::string, double> what_if_weights_;
+    double what_if_ts_scale_ = 1.0;
+    std::vector<ScenarioScore> what_if_scores_;
+    long long what_if_generation_ = 0;
 
     int page_ = 1;
     int selected_member_row_ = 0;
+    // Members table viewport: first visible row, and the row count of the last
+    // draw (the PgUp/PgDn step). Only those rows are formatted.
+    int member_view_top_ = 0;
+    int member_page_rows_ = 1;
+    int members_max_cp_ = 1;
+    NamePrefixIndex member_names_;
+    // `/` search or `:` jump-to-rank being typed on the Members page.
+    enum class MemberPrompt { None, Search, Rank };
+    MemberPrompt member_prompt_ = MemberPrompt::None;
+    std::string member_prompt_text_;
+    std::string member_search_;  // last query, for `n`
+    int member_search_matches_ = 0;
+    long long member_view_generation_ = 0;
     SortKey sort_key_ = SortKey::Cp;
+    MemberOrderIndex member_order_;
+    // Indices into channels_ per ChannelActivityRange, busiest first; sorted
+    // once per snapshot rather than on every draw.
+    std::array<std::vector<int>, kChannelActivityRangeCount> channel_orders_;
     ChannelActivityRange channel_activity_range_ = ChannelActivityRange::All;
+    ActivityZoom activity_zoom_ = ActivityZoom::Day;
     bool using_mock_data_ = false;
     bool db_ready_ = false;
     bool members_table_available_ = false;
     bool votes_table_available_ = false;
     bool issues_table_available_ = false;
+    unsigned loading_tables_ = 0;  // DashboardSnapshot::loading_tables
+    int stage2_queue_ = -1;
     std::string data_status_ = "MOCK";
     std::string last_refresh_hms_ = "-";
     std::string last_error_;
-    std::unordered_map<long long, std::string> user_name_by_id_;
-    std::unordered_map<long long, std::string> channel_name_by_id_;
+    std::string metrics_label_;
     int db_refresh_interval_sec_ = 30;
     std::chrono::steady_clock::time_point last_db_refresh_ = std::chrono::steady_clock::now();
     std::mt19937 rng_;
@@ -785,38 +6072,104 @@ private:
     std::vector<MemberRowHit> member_row_hits_;
     std::vector<ChannelRangeHit> channel_range_hits_;
 
-    QueryResult query_supabase(
-        const std::string& endpoint,
-        const std::vector<std::string>& query_params,
-        const std::string& jq_program
-    ) const {
-        QueryResult out;
-        std::string script = "set -o pipefail; "
-                             "if [ -z \"$SUPABASE_URL\" ] || [ -z \"$SUPABASE_KEY\" ]; then "
-                             "echo \"SUPABASE_URL/SUPABASE_KEY missing\"; exit 64; fi; "
-                             "AUTH_TOKEN=\"${SUPABASE_AUTH_TOKEN:-$SUPABASE_KEY}\"; "
-                             "curl -sS --fail --get \"$SUPABASE_URL/rest/v1/" + endpoint + "\" "
-                             "-H \"apikey: $SUPABASE_KEY\" "
-                             "-H \"Authorization: Bearer $AUTH_TOKEN\" "
-                             "2>/dev/null ";
-        for (const auto& param : query_params) {
-            script += "--data-urlencode " + shell_quote(param) + " ";
-        }
-        script += "| jq -r " + shell_quote(jq_program);
+    // Refresh worker. Only the worker touches supabase_/upstream_, the state
+    // below them and load_snapshot(); results cross to the UI thread through
+    // pending_outcome_.
+    SupabaseFetchPool supabase_;
+    std::unique_ptr<UpstreamClient> upstream_;
+    std::unique_ptr<RealtimeFeed> realtime_;
+    // Members detail queries; its own thread, fed channel labels by the worker.
+    std::unique_ptr<MemberActivityFetcher> member_activity_;
+    uint64_t member_activity_generation_ = 0;  // UI thread
+    ActivityAggregator activity_;
+    AggregationPool aggregation_pool_;
+    ActivityAggregator::MessageBatch message_batch_;
+    ScratchArena build_arena_;
+    std::vector<QueryResult> last_results_;  // the slots before kMessagesQuery
+    std::vector<std::chrono::steady_clock::time_point> table_fetched_;  // per last_results_ slot
+    // kTablePages bits of what is on screen, set by the UI (every page for --serve).
+    std::atomic<unsigned> visible_pages_{page_bit(1)};
+    unsigned prefetch_tables_ = 0;  // QueryIndex bits the last load left off-screen for later
+    EventLog event_log_;
+    // Stage2 for Misc messages, with COMM0NS_TUI_STAGE2_URL set.
+    std::unique_ptr<Stage2Classifier> stage2_;
+    Stage2Cache stage2_cache_;
+    std::vector<Stage2Item> stage2_submissions_;
+    std::unique_ptr<EventReplay> replay_;
+    int64_t replay_time_ = 0;  // the moment shown with --replay
+    std::unordered_map<long long, std::string> channel_name_by_id_;
+    // Per interned channel: null until its label is first seen, then channel_profile().
+    std::vector<const ChannelProfile*> profile_by_channel_;
+    // realtime_->joins() at the last activity fetch, and the marks it left: pushed
+    // rows older than those may have been polled already.
+    std::optional<uint64_t> activity_joins_;
+    std::string message_floor_;
+    std::string reaction_floor_;
+    SnapshotCache snapshot_cache_;
+    bool showing_cache_ = false;
+    std::thread refresh_worker_;
+    std::mutex refresh_mutex_;
+    std::condition_variable refresh_cv_;
+    bool refresh_stop_ = false;
+    bool refresh_requested_ = false;
+    bool refresh_manual_ = false;
+    bool realtime_pending_ = false;
+    bool stage2_pending_ = false;
+    bool page_changed_ = false;
+    std::unique_ptr<RefreshOutcome> pending_outcome_;
+    std::atomic<bool> outcome_ready_{false};
+    std::atomic<bool> refresh_in_flight_{false};
+    // Self-pipe: the worker writes a byte so the UI's poll() wakes up at once.
+    std::array<int, 2> wake_pipe_{-1, -1};
+
+    // Damage tracking. Each panel renders into its own window and is redrawn
+    // only when the inputs it was rendered from change; the top bar is redrawn
+    // when its text changes (clock, status). data_generation_ counts adopted
+    // refresh outcomes.
+    enum PanelId : size_t {
+        kOverviewActivityPanel,
+        kOverviewStatsPanel,
+        kOverviewFeedPanel,
+        kOverviewCategoryPanel,
+        kMembersTablePanel,
+        kMemberDetailPanel,
+        kChannelsLeftPanel,
+        kChannelsRightPanel,
+        kVotesPanel,
+        kVpPanel,
+        kIssuesPanel,
+        kPerfFetchPanel,
+        kPerfRuntimePanel,
+        kPanelCount
+    };
 
-        const ShellResult shell = run_shell("bash -lc " + shell_quote(script));
-        if (shell.exit_code != 0) {
-            out.error = shell.output.empty() ? "query failed" : shell.output;
-            return out;
-        }
+    // draw() wall time and this thread's allocations, per page.
+    struct FramePerf {
+        SampleWindow time_us;
+        SampleWindow allocs;
+    };
+    std::array<FramePerf, kPageCount> frame_perf_;
 
-        out.ok = true;
-        out.rows.reserve(shell.lines.size());
-        for (const auto& line : shell.lines) {
-            out.rows.push_back(split_tsv_line(line));
-        }
-        return out;
-    }
+    using PanelInputs = std::array<long long, 4>;
+
+    struct Panel {
+        WINDOW* win = nullptr;
+        int y = 0;
+        int x = 0;
+        int h = 0;
+        int w = 0;
+        bool valid = false;
+        PanelInputs inputs{};
+    };
+
+    std::array<Panel, kPanelCount> panels_;
+    long long data_generation_ = 0;
+    int layout_h_ = -1;
+    int layout_w_ = -1;
+    int shown_page_ = 0;
+    bool layout_dirty_ = true;
+    std::string shown_topbar_;
+    bool expose_panels_ = false;
 
     void init_empty_state() {
         members_.clear();
@@ -825,13 +6178,10 @@ private:
         issues_.clear();
         feed_.clear();
         samples_.clear();
-        total_hist_.assign(kHistoryWidth, 0);
-        info_hist_.assign(kHistoryWidth, 0);
-        insight_hist_.assign(kHistoryWidth, 0);
-        vibe_hist_.assign(kHistoryWidth, 0);
-        ops_hist_.assign(kHistoryWidth, 0);
+        series_ = ActivitySeries();
+        daily_pulse_.clear();
         feed_.push_back({"INFO", "system", "Waiting for Supabase data..."});
-        samples_.push_back({"#system", "Supabase data not loaded yet."});
+        samples_.push_back({"#system", "Supabase data not loaded yet.", Category::Misc});
         const int today_serial = today_day_serial();
         sprint_ = {"Current Sprint", iso_date_from_serial(today_serial), iso_date_from_serial(today_serial + 13), {}, 20};
     }
@@ -839,15 +6189,17 @@ private:
     // Legacy mock dataset (kept for reference, currently disabled).
     void init_mock_data() {
         members_ = {
-            {"Tate", 2847, 100, 34, 312, 287, 198, 156, 42, true, {"Tech-Lord", "Contributor"}, 14},
-            {"Haru", 1923, 95, 21, 198, 234, 267, 89, 31, true, {"Polity-Lord", "Citizen"}, 12},
-            {"Mina", 1456, 100, 15, 245, 156, 312, 67, 28, true, {"Sun", "Informant"}, 10},
-            {"Ken", 1102, 88, 8, 89, 112, 356, 45, 67, false, {"Meme-Lord"}, 7},
-            {"Aoi", 876, 100, 12, 187, 198, 134, 78, 19, true, {"Lore-Lord", "Thinker"}, 8},
-            {"Riku", 654, 92, 5, 98, 134, 156, 145, 23, false, {"Backstage"}, 9},
-            {"Yuu", 423, 100, 3, 56, 78, 178, 34, 31, true, {"Sprout"}, 6},
-            {"Sora", 287, 100, 7, 45, 67, 98, 23, 15, false, {}, 4},
+            {"Tate", 2847, 100, 34, 312, 287, 198, 156, 42, true, {"Tech-Lord", "Contributor"}, 14, 7, 30},
+            {"Haru", 1923, 95, 21, 198, 234, 267, 89, 31, true, {"Polity-Lord", "Citizen"}, 12, 7, 27},
+            {"Mina", 1456, 100, 15, 245, 156, 312, 67, 28, true, {"Sun", "Informant"}, 10, 7, 24},
+            {"Ken", 1102, 88, 8, 89, 112, 356, 45, 67, false, {"Meme-Lord"}, 7, 7, 13},
+            {"Aoi", 876, 100, 12, 187, 198, 134, 78, 19, true, {"Lore-Lord", "Thinker"}, 8, 7, 20},
+            {"Riku", 654, 92, 5, 98, 134, 156, 145, 23, false, {"Backstage"}, 9, 5, 14},
+            {"Yuu", 423, 100, 3, 56, 78, 178, 34, 31, true, {"Sprout"}, 6, 4, 9},
+            {"Sora", 287, 100, 7, 45, 67, 98, 23, 15, false, {}, 4, 7, 11},
         };
+        member_order_.update(members_);
+        index_members();
 
         channels_ = {
             {"#general", 234, 126, 38, "Mina", 7, 1.0},
@@ -859,6 +6211,8 @@ private:
             {"#book-commons", 76, 47, 16, "Aoi", 3, 1.2},
             {"#music", 45, 25, 8, "Yuu", 2, 0.8}
         };
+        rebuild_channel_orders();
+        measure_display_widths();
 
         votes_ = {
             {"007", "Deploy Comm0ns Scoring v2", "major", 18, 3, 6, 8, 5},
@@ -871,89 +6225,646 @@ private:
             {44, "Auto-generate monthly reports", "feature", "low", "open", "-"},
             {45, "Migrate to PostgREST 12", "ops", "high", "in-progress", "@fumi"},
         };
-
-        feed_ = {
-            {"ACHV", "Tate", "earned title: Contributor"},
-            {"VOTE", "Haru", "created major vote #007"},
-            {"QEST", "Ken", "quest cleared: logo refresh (+50)"},
-            {"INFO", "Aoi", "shared AI paper in #learning (+5)"},
-            {"STRK", "Tate", "30-day streak bonus (+15)"},
-            {"ISSU", "Riku", "closed issue #42"},
-            {"OPS", "Riku", "posted sprint cadence update (+4)"},
-            {"INSI", "Haru", "policy analysis accepted (+4)"}
+
+        feed_ = {
+            {"ACHV", "Tate", "earned title: Contributor"},
+            {"VOTE", "Haru", "created major vote #007"},
+            {"QEST", "Ken", "quest cleared: logo refresh (+50)"},
+            {"INFO", "Aoi", "shared AI paper in #learning (+5)"},
+            {"STRK", "Tate", "30-day streak bonus (+15)"},
+            {"ISSU", "Riku", "closed issue #42"},
+            {"OPS", "Riku", "posted sprint cadence update (+4)"},
+            {"INSI", "Haru", "policy analysis accepted (+4)"}
+        };
+
+        samples_ = {
+            {"#learning", "https://arxiv.org/abs/2501.00001 Great benchmark summary."},
+            {"#governance", "Please vote by Friday. We need quorum for major proposal."},
+            {"#general", "nice!"},
+            {"#dev", "I benchmarked two caching strategies and variant B lowered p95 latency by 37%."},
+            {"#random", "lol"},
+            {"#article-share", "A practical guide for DAOs with governance case studies."},
+        };
+        for (auto& sample : samples_) {
+            sample.category = classify_stage1(is_ops_channel(sample.channel), sample.text);
+        }
+
+        sprint_ = {"Sprint-3", "2026-03-01", "2026-03-14", {42, 43, 45}, 20};
+    }
+
+    // Legacy mock histories (kept for reference, currently disabled).
+    void init_mock_histories() {
+        std::uniform_int_distribution<int> per_slot(0, 4);
+        std::uniform_int_distribution<int> category_d(0, static_cast<int>(kCategoryCount) - 1);
+
+        series_ = ActivitySeries();
+        const long long now = now_epoch_minute();
+        for (long long minute = now - 30LL * 1440; minute <= now; minute += 5) {
+            for (int n = per_slot(rng_); n > 0; --n) {
+                series_.add(minute, static_cast<Category>(category_d(rng_)));
+            }
+        }
+    }
+
+    static QuerySpec users_spec() {
+        QuerySpec spec{
+            "users",
+            {"select=user_id,username,current_score,weekly_score"},
+            {{{"user_id"}, "", FieldType::Int}, {{"username"}, ""}, {{"current_score"}, "0", FieldType::Real}, {{"weekly_score"}, "0", FieldType::Real}}
+        };
+        spec.cursor_key = "user_id";
+        return spec;
+    }
+
+    // Full syncs walk the whole table by primary key; deltas walk the timestamp
+    // (ties broken by the primary key) from the mark, inclusively, relying on the
+    // aggregator to drop repeats.
+    static QuerySpec messages_spec(const std::string& mark) {
+        QuerySpec spec{
+            "messages",
+            {"select=message_id,user_id,channel_id,content,timestamp"},
+            {{{"message_id"}, "", FieldType::Int}, {{"user_id"}, "", FieldType::Int}, {{"channel_id"}, "", FieldType::Int}, {{"content"}, ""}, {{"timestamp"}, "", FieldType::Day}}
+        };
+        if (mark.empty()) {
+            spec.cursor_key = "message_id";
+            spec.cursor_field = 0;
+        } else {
+            spec.cursor_key = "timestamp";
+            spec.cursor_field = 4;
+            spec.cursor_start = mark;
+            spec.cursor_inclusive = true;
+            spec.tiebreak_key = "message_id";
+            spec.tiebreak_field = 0;
+        }
+        return spec;
+    }
+
+    static QuerySpec reactions_spec(const std::string& mark) {
+        QuerySpec spec{
+            "reactions",
+            {"select=message_id,user_id,created_at,id"},
+            {{{"message_id"}, "", FieldType::Int}, {{"user_id"}, "", FieldType::Int}, {{"created_at"}, "", FieldType::Day}, {{"id"}, ""}}
+        };
+        if (mark.empty()) {
+            spec.cursor_key = "id";
+            spec.cursor_field = 3;
+        } else {
+            spec.cursor_key = "created_at";
+            spec.cursor_field = 2;
+            spec.cursor_start = mark;
+            spec.cursor_inclusive = true;
+            spec.tiebreak_key = "id";
+            spec.tiebreak_field = 3;
+        }
+        return spec;
+    }
+
+    // Slots of one poll. The activity tables come last so a poll that leaves them
+    // to the realtime feed simply stops short.
+    enum QueryIndex : size_t {
+        kUsersQuery,
+        kMembersQuery,
+        kChannelsQuery,
+        kPulseQuery,
+        kChannelLeadersQuery,
+        kChannelRankingQuery,
+        kVotesQuery,
+        kIssuesQuery,
+        kMessagesQuery,
+        kReactionsQuery,
+        kQueryCount
+    };
+
+    // How long a slow table's last result stays current, in seconds. Polls run
+    // every db_refresh_interval_sec_ and only re-request the tables that are
+    // due; messages/reactions follow every poll and `r` re-requests everything.
+    static constexpr std::array<int, kMessagesQuery> kTableRefreshSec = {
+        30,   // users: scores move with every message
+        120,  // members
+        300,  // channels
+        300,  // analytics_daily_pulse
+        120,  // analytics_channel_leader_user
+        120,  // analytics_channel_ranking
+        30,   // votes
+        60,   // issues
+    };
+
+    // The pages (bit N for page N) that show each table. The others keep it at
+    // kOffscreenRefreshSec; the first load leaves them to a prefetch that runs
+    // as soon as it is shown. users and channels feed every page (and the
+    // message fold).
+    static constexpr unsigned kAllPages = ~0u;
+    static constexpr std::array<unsigned, kMessagesQuery> kTablePages = {
+        kAllPages,                                  // users
+        page_bit(1) | page_bit(2) | page_bit(4),    // members: TS
+        kAllPages,                                  // channels
+        page_bit(1),                                // analytics_daily_pulse: 30d activity
+        page_bit(3),                                // analytics_channel_leader_user
+        page_bit(3),                                // analytics_channel_ranking
+        page_bit(1) | page_bit(4),                  // votes
+        page_bit(1) | page_bit(5),                  // issues
+    };
+    static constexpr int kOffscreenRefreshSec = 300;
+
+    static int table_refresh_sec(size_t table, unsigned visible) {
+        return (kTablePages[table] & visible) ? kTableRefreshSec[table]
+                                              : std::max(kTableRefreshSec[table], kOffscreenRefreshSec);
+    }
+
+    // Worker: whether a table the `visible` pages show is past its interval
+    // (or was left for the prefetch). False before the first load.
+    bool visible_tables_due(unsigned visible) const {
+        if (table_fetched_.size() < kMessagesQuery) {
+            return false;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < kMessagesQuery; ++i) {
+            if ((kTablePages[i] & visible) && now - table_fetched_[i] >= std::chrono::seconds(kTableRefreshSec[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Server-side rollups (migrations/006_activity_rollups.sql), read in place of
+    // the messages/reactions history on a full sync. Each row repeats the
+    // `through` cutoff of the refresh that produced it.
+    enum RollupIndex : size_t {
+        kActivityRollup,
+        kReactionRollup,
+        kMinuteRollup,
+        kRollupCount
+    };
+
+    static std::vector<QuerySpec> rollup_specs() {
+        const std::vector<QueryField> counts = {
+            {{"info"}, "0", FieldType::Int}, {{"insight"}, "0", FieldType::Int}, {{"vibe"}, "0", FieldType::Int},
+            {{"ops"}, "0", FieldType::Int}, {{"misc"}, "0", FieldType::Int}
+        };
+        std::vector<QuerySpec> specs(kRollupCount);
+        specs[kActivityRollup] = {
+            "analytics_activity_rollup",
+            {"select=row_id,day,user_id,channel_id,info,insight,vibe,ops,misc,through"},
+            {{{"row_id"}, "", FieldType::Int}, {{"day"}, "", FieldType::Day}, {{"user_id"}, "", FieldType::Int}, {{"channel_id"}, "", FieldType::Int}}
+        };
+        specs[kReactionRollup] = {
+            "analytics_reaction_rollup",
+            {"select=row_id,day,user_id,reactions,through"},
+            {{{"row_id"}, "", FieldType::Int}, {{"day"}, "", FieldType::Day}, {{"user_id"}, "", FieldType::Int}, {{"reactions"}, "0", FieldType::Int}, {{"through"}, ""}}
+        };
+        specs[kMinuteRollup] = {
+            "analytics_activity_minutes",
+            {"select=minute,info,insight,vibe,ops,misc,through"},
+            {{{"minute"}, ""}}
+        };
+        specs[kActivityRollup].fields.insert(specs[kActivityRollup].fields.end(), counts.begin(), counts.end());
+        specs[kActivityRollup].fields.push_back({{"through"}, ""});
+        specs[kMinuteRollup].fields.insert(specs[kMinuteRollup].fields.end(), counts.begin(), counts.end());
+        specs[kMinuteRollup].fields.push_back({{"through"}, ""});
+        specs[kActivityRollup].cursor_key = "row_id";
+        specs[kReactionRollup].cursor_key = "row_id";
+        specs[kMinuteRollup].cursor_key = "minute";
+        return specs;
+    }
+
+    // The five category columns starting at `col`, in Category order.
+    static std::array<int, kCategoryCount> rollup_counts(const QueryResult& page, size_t row, size_t col) {
+        std::array<int, kCategoryCount> counts{};
+        for (size_t cat = 0; cat < kCategoryCount; ++cat) {
+            counts[cat] = static_cast<int>(page.integer(row, col + cat));
+        }
+        return counts;
+    }
+
+    // The newest messages a rollup ending at `through` counted, for the feed.
+    static QuerySpec recent_messages_spec(const std::string& through) {
+        QuerySpec spec = messages_spec("");
+        spec.cursor_key.clear();
+        spec.params.push_back("timestamp=lt." + through);
+        spec.params.push_back("order=timestamp.desc");
+        spec.params.push_back("limit=20");
+        return spec;
+    }
+
+    // Stage1 classification keys off the channel label, looked up once per
+    // interned channel and load. Rows timestamped before `floor` are skipped:
+    // realtime rows a poll may already have folded.
+    void fold_message_page(const QueryResult& page, std::string_view floor) {
+        const std::vector<long long>& message_ids = page.integers(0);
+        const std::vector<long long>& user_ids = page.integers(1);
+        const std::vector<long long>& channel_ids = page.integers(2);
+        ActivityAggregator::MessageBatch& batch = message_batch_;
+        batch.clear();
+        for (size_t row = 0; row < page.size(); ++row) {
+            const long long message_id = message_ids[row];
+            const long long user_id = user_ids[row];
+            const long long channel_id = channel_ids[row];
+            if (user_id == 0 || channel_id == 0 || message_id == 0 || page.text(row, 4) < floor) {
+                continue;
+            }
+            const bool ops = profile_of(channel_id).ops;
+            batch.add(message_id, activity_.intern_user(user_id), activity_.intern_channel(channel_id), ops,
+                      page.text(row, 3), page.text(row, 4), page.day(row, 4));
+        }
+        if (!activity_.fold_messages(batch, aggregation_pool_)) {
+            return;
+        }
+        if (stage2_) {
+            refine_stage2(batch);
+        }
+        if (!event_log_.enabled()) {
+            return;
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (!batch.folded[i]) {
+                continue;
+            }
+            const long long channel_id = activity_.channel_id(batch.channels[i]);
+            auto name_it = channel_name_by_id_.find(channel_id);
+            event_log_.append_message(batch.message_ids[i], activity_.user_id(batch.users[i]), channel_id,
+                                      name_it != channel_name_by_id_.end() ? std::string_view(name_it->second) : std::string_view(),
+                                      batch.categories[i], batch.contents[i], batch.timestamps[i], batch.days[i]);
+        }
+    }
+
+    // Folded Misc rows: a cached verdict applies at once, the rest are queued
+    // for the classifier.
+    void refine_stage2(ActivityAggregator::MessageBatch& batch) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (!batch.folded[i] || batch.categories[i] != Category::Misc) {
+                continue;
+            }
+            const long long user_id = activity_.user_id(batch.users[i]);
+            const long long channel_id = activity_.channel_id(batch.channels[i]);
+            if (const Stage2Record* record = stage2_cache_.find(batch.message_ids[i])) {
+                batch.categories[i] = apply_stage2(*record, batch.minutes[i], Category::Misc);
+            } else {
+                queue_stage2(batch.message_ids[i], user_id, channel_id, batch.contents[i], batch.timestamps[i]);
+            }
+        }
+        stage2_->submit(stage2_submissions_);
+    }
+
+    Category apply_stage2(const Stage2Record& record, std::optional<long long> minute, Category counted_as) {
+        activity_.reclassify(record.message_id, record.user_id, record.channel_id, minute, counted_as, record.verdict(),
+                             record.confidence);
+        return record.verdict();
+    }
+
+    void queue_stage2(long long message_id, long long user_id, long long channel_id, std::string_view content,
+                      std::string_view timestamp) {
+        auto name_it = channel_name_by_id_.find(channel_id);
+        stage2_submissions_.push_back({message_id, user_id, channel_id, parse_epoch_second(timestamp).value_or(0),
+                                       normalize_channel_label(name_it != channel_name_by_id_.end() ? name_it->second : "", channel_id),
+                                       std::string(content)});
+    }
+
+    // A rollup-seeded sync counts every message before `through` as Stage1 left
+    // it; the cached verdicts move those back out of Misc. Rows in the cutoff's
+    // own second may fall on either side of it and stay as counted.
+    void apply_cached_stage2(std::string_view through) {
+        const std::optional<long long> cutoff = parse_epoch_second(through);
+        if (!stage2_ || !cutoff) {
+            return;
+        }
+        stage2_cache_.for_each([&](const Stage2Record& record) {
+            if (record.time < *cutoff) {
+                apply_stage2(record, record.time / 60, Category::Misc);
+            }
+        });
+    }
+
+    const ChannelProfile& profile_of(long long channel_id) {
+        const uint32_t channel = activity_.intern_channel(channel_id);
+        if (channel >= profile_by_channel_.size()) {
+            profile_by_channel_.resize(channel + 1, nullptr);
+        }
+        if (!profile_by_channel_[channel]) {
+            auto name_it = channel_name_by_id_.find(channel_id);
+            profile_by_channel_[channel] = &channel_profile(normalize_channel_label(
+                name_it != channel_name_by_id_.end() ? name_it->second : "",
+                channel_id
+            ));
+        }
+        return *profile_by_channel_[channel];
+    }
+
+    void fold_reaction_page(const QueryResult& page, std::string_view floor) {
+        const std::vector<long long>& message_ids = page.integers(0);
+        const std::vector<long long>& reactor_ids = page.integers(1);
+        for (size_t row = 0; row < page.size(); ++row) {
+            if (reactor_ids[row] == 0 || page.text(row, 2) < floor) {
+                continue;
+            }
+            if (activity_.fold_reaction(message_ids[row], reactor_ids[row], page.text(row, 2), page.day(row, 2))) {
+                event_log_.append_reaction(message_ids[row], reactor_ids[row], page.text(row, 2), page.day(row, 2));
+            }
+        }
+    }
+
+    // Runs on the refresh worker: touches only `snap` and worker-owned state.
+    // messages/reactions are streamed page by page straight into activity_: the
+    // whole history on a full sync, only rows past its high-water marks on a
+    // delta sync. A full sync happens when `full_resync` is set or none has
+    // completed yet; it is seeded from the rollup views when they are there, so
+    // only the rows past their cutoff are read raw. While the realtime feed is
+    // joined they are left out: its pushes carry them, and a delta after each
+    // (re)join covers the gap.
+    bool load_snapshot(DashboardSnapshot& snap, std::string& error, bool full_resync) {
+        PerfRefreshScope perf_refresh;
+        bool full_sync = full_resync || !activity_.synced();
+        if (full_sync) {
+            activity_.reset();
+        }
+        const uint64_t joins = realtime_ ? realtime_->joins() : 0;
+        const bool fetch_activity = full_sync || !realtime_ || !realtime_->live() || activity_joins_ != joins;
+
+        channel_name_by_id_.clear();
+        profile_by_channel_.clear();
+
+        // Message pages wait for the channels slot; every other slot runs
+        // unhindered.
+        std::promise<void> channels_loaded;
+        std::shared_future<void> channels_ready = channels_loaded.get_future().share();
+        std::mutex fold_mutex;
+
+        auto activity_specs = [&](bool full) {
+            std::pair<QuerySpec, QuerySpec> out{
+                messages_spec(full ? std::string() : activity_.message_mark()),
+                reactions_spec(full ? std::string() : activity_.reaction_mark())
+            };
+            out.first.on_page = [&](const QueryResult& page) {
+                channels_ready.wait();
+                std::lock_guard<std::mutex> lock(fold_mutex);
+                ScopedPerfTimer fold_timer(PerfStage::Aggregate, true);
+                fold_message_page(page, {});
+            };
+            out.second.on_page = [&](const QueryResult& page) {
+                std::lock_guard<std::mutex> lock(fold_mutex);
+                ScopedPerfTimer fold_timer(PerfStage::Aggregate, true);
+                fold_reaction_page(page, {});
+            };
+            return out;
+        };
+
+        std::vector<QuerySpec> specs(kQueryCount);
+        specs[kUsersQuery] = users_spec();
+        specs[kMembersQuery] = {
+            "members",
+            {"select=*", "limit=1000"},
+            {{{"user_id", "member_id", "discord_user_id", "id"}, "0", FieldType::Int}, {{"ts", "trust_score", "ts_score", "trust"}, "100", FieldType::Real}}
+        };
+        specs[kChannelsQuery] = {
+            "channels",
+            {"select=channel_id,name"},
+            {{{"channel_id"}, "", FieldType::Int}, {{"name"}, ""}}
+        };
+        specs[kChannelsQuery].cursor_key = "channel_id";
+        specs[kChannelsQuery].on_done = [&](const QueryResult& channels_q) {
+            if (channels_q.ok) {
+                for (size_t row = 0; row < channels_q.size(); ++row) {
+                    const long long cid = channels_q.integer(row, 0);
+                    if (cid == 0) {
+                        continue;
+                    }
+                    channel_name_by_id_[cid] = normalize_channel_label(std::string(channels_q.text(row, 1)), cid);
+                }
+            }
+            channels_loaded.set_value();
+        };
+        specs[kPulseQuery] = {
+            "analytics_daily_pulse",
+            {"select=day,total_messages", "order=day.desc", "limit=60"},
+            {{{"day"}, "", FieldType::Day}, {{"total_messages"}, "0", FieldType::Int}}
+        };
+        specs[kChannelLeadersQuery] = {
+            "analytics_channel_leader_user",
+            {"select=channel_id,username"},
+            {{{"channel_id"}, "", FieldType::Int}, {{"username"}, "-"}}
+        };
+        specs[kChannelRankingQuery] = {
+            "analytics_channel_ranking",
+            {"select=channel_id,channel_name,total_messages,active_users", "order=total_messages.desc", "limit=120"},
+            {{{"channel_id"}, "", FieldType::Int}, {{"channel_name"}, ""}, {{"total_messages"}, "0", FieldType::Int}, {{"active_users"}, "0", FieldType::Int}}
+        };
+        specs[kVotesQuery] = {
+            "votes",
+            {"select=*", "limit=30"},
+            {{{"id", "vote_id", "proposal_id"}, "0"}, {{"title", "name"}, "(untitled)"}, {{"type", "vote_type"}, "normal"}, {{"yes_vp", "yes_votes", "yes"}, "0", FieldType::Int}, {{"no_vp", "no_votes", "no"}, "0", FieldType::Int}, {{"voters", "voter_count"}, "0", FieldType::Int}, {{"total_eligible", "eligible_voters", "eligible"}, "0", FieldType::Int}, {{"days_left", "remaining_days"}, "0", FieldType::Int}}
         };
-
-        samples_ = {
-            {"#learning", "https://arxiv.org/abs/2501.00001 Great benchmark summary."},
-            {"#governance", "Please vote by Friday. We need quorum for major proposal."},
-            {"#general", "nice!"},
-            {"#dev", "I benchmarked two caching strategies and variant B lowered p95 latency by 37%."},
-            {"#random", "lol"},
-            {"#article-share", "A practical guide for DAOs with governance case studies."},
+        specs[kIssuesQuery] = {
+            "issues",
+            {"select=*", "limit=50"},
+            {{{"id", "issue_id"}, "0", FieldType::Int}, {{"title", "name"}, "(untitled)"}, {{"label", "type"}, "-"}, {{"priority"}, "medium"}, {{"status"}, "open"}, {{"assignee", "owner"}, "-"}}
         };
+        // A full sync reads the server-side rollups in place of the history,
+        // then the rows since their cutoff as an ordinary delta. Without the
+        // rollups (or with none refreshed yet) it walks the raw tables.
+        const bool seed_from_rollups = fetch_activity && full_sync;
+        std::string rollup_through;
+        bool rollups_consistent = true;
+        auto note_through = [&](std::string_view through) {
+            if (rollup_through.empty()) {
+                rollup_through.assign(through.data(), through.size());
+            } else if (through != rollup_through) {
+                rollups_consistent = false;  // refreshed while we were paging
+            }
+        };
+        if (fetch_activity && !seed_from_rollups) {
+            std::tie(specs[kMessagesQuery], specs[kReactionsQuery]) = activity_specs(false);
+        } else {
+            specs.resize(kMessagesQuery);
+        }
+        if (seed_from_rollups) {
+            std::vector<QuerySpec> rollups = rollup_specs();
+            rollups[kActivityRollup].on_page = [&](const QueryResult& page) {
+                std::lock_guard<std::mutex> lock(fold_mutex);
+                ScopedPerfTimer fold_timer(PerfStage::Aggregate, true);
+                for (size_t row = 0; row < page.size(); ++row) {
+                    const std::optional<int> day = page.day(row, 1);
+                    const long long user_id = page.integer(row, 2);
+                    const long long channel_id = page.integer(row, 3);
+                    note_through(page.text(row, 9));
+                    if (!day || user_id == 0 || channel_id == 0) {
+                        continue;
+                    }
+                    activity_.fold_rollup(activity_.intern_user(user_id), activity_.intern_channel(channel_id), *day,
+                                          rollup_counts(page, row, 4));
+                }
+            };
+            rollups[kReactionRollup].on_page = [&](const QueryResult& page) {
+                std::lock_guard<std::mutex> lock(fold_mutex);
+                ScopedPerfTimer fold_timer(PerfStage::Aggregate, true);
+                for (size_t row = 0; row < page.size(); ++row) {
+                    const std::optional<int> day = page.day(row, 1);
+                    const long long user_id = page.integer(row, 2);
+                    note_through(page.text(row, 4));
+                    if (day && user_id != 0) {
+                        activity_.fold_reaction_rollup(user_id, *day, static_cast<int>(page.integer(row, 3)));
+                    }
+                }
+            };
+            rollups[kMinuteRollup].on_page = [&](const QueryResult& page) {
+                std::lock_guard<std::mutex> lock(fold_mutex);
+                ScopedPerfTimer fold_timer(PerfStage::Aggregate, true);
+                for (size_t row = 0; row < page.size(); ++row) {
+                    note_through(page.text(row, 6));
+                    if (const std::optional<long long> minute = parse_epoch_minute(page.text(row, 0))) {
+                        activity_.fold_minute_rollup(*minute, rollup_counts(page, row, 1));
+                    }
+                }
+            };
+            for (QuerySpec& spec : rollups) {
+                specs.push_back(std::move(spec));
+            }
+        }
+        // Tables inside their refresh interval keep the last result; the others
+        // are revalidated, so an unchanged one still costs no parse. The first
+        // load fetches only what the visible page shows.
+        static const QueryResult kNotLoaded;
+        const auto fetched_at = std::chrono::steady_clock::now();
+        const unsigned visible = visible_pages_;
+        prefetch_tables_ = 0;
+        for (size_t i = 0; i < kMessagesQuery; ++i) {
+            specs[i].revalidate = true;
+            if (full_resync) {
+                continue;
+            }
+            if (last_results_.empty() && !(kTablePages[i] & visible)) {
+                specs[i].reuse = &kNotLoaded;
+                prefetch_tables_ |= 1u << i;
+            } else if (i < last_results_.size() && last_results_[i].ok &&
+                       fetched_at - table_fetched_[i] < std::chrono::seconds(table_refresh_sec(i, visible))) {
+                specs[i].reuse = &last_results_[i];
+            }
+        }
+        std::vector<QueryResult> results = supabase_.fetch_all(specs);
+        table_fetched_.resize(kMessagesQuery);
+        for (size_t i = 0; i < kMessagesQuery; ++i) {
+            if (!specs[i].reuse) {
+                table_fetched_[i] = fetched_at;
+            }
+        }
+        if (member_activity_) {
+            member_activity_->set_channel_labels(channel_name_by_id_);
+        }
 
-        sprint_ = {"Sprint-3", "2026-03-01", "2026-03-14", {42, 43, 45}, 20};
-    }
-
-    // Legacy mock histories (kept for reference, currently disabled).
-    void init_mock_histories() {
-        std::uniform_int_distribution<int> total_d(20, 70);
-        std::uniform_int_distribution<int> info_d(4, 25);
-        std::uniform_int_distribution<int> insight_d(4, 24);
-        std::uniform_int_distribution<int> vibe_d(6, 30);
-        std::uniform_int_distribution<int> ops_d(3, 18);
-
-        total_hist_.resize(kHistoryWidth);
-        info_hist_.resize(kHistoryWidth);
-        insight_hist_.resize(kHistoryWidth);
-        vibe_hist_.resize(kHistoryWidth);
-        ops_hist_.resize(kHistoryWidth);
-
-        for (int i = 0; i < kHistoryWidth; ++i) {
-            total_hist_[i] = total_d(rng_);
-            info_hist_[i] = info_d(rng_);
-            insight_hist_[i] = insight_d(rng_);
-            vibe_hist_[i] = vibe_d(rng_);
-            ops_hist_[i] = ops_d(rng_);
+        if (fetch_activity) {
+            std::vector<QueryResult> tail_results;
+            if (seed_from_rollups) {
+                const bool seeded = rollups_consistent && !rollup_through.empty() &&
+                    std::all_of(results.begin() + kMessagesQuery, results.end(), [](const QueryResult& q) { return q.ok; });
+                std::vector<QuerySpec> tail_specs(2);
+                if (seeded) {
+                    activity_.resume_from(rollup_through);
+                    apply_cached_stage2(rollup_through);
+                    std::tie(tail_specs[0], tail_specs[1]) = activity_specs(false);
+                    // The rollups carry no text: the feed comes from the newest rows
+                    // they counted (and from the delta).
+                    tail_specs.push_back(recent_messages_spec(rollup_through));
+                    tail_specs.back().on_page = [&](const QueryResult& page) {
+                        std::lock_guard<std::mutex> lock(fold_mutex);
+                        for (size_t row = 0; row < page.size(); ++row) {
+                            const long long message_id = page.integer(row, 0);
+                            const long long user_id = page.integer(row, 1);
+                            const long long channel_id = page.integer(row, 2);
+                            const Category category = classify_stage1(profile_of(channel_id).ops, page.text(row, 3));
+                            activity_.add_recent(message_id, user_id, channel_id, page.text(row, 3), category, page.text(row, 4));
+                            if (!stage2_ || category != Category::Misc) {
+                                continue;
+                            }
+                            // Counted by the rollups: a cached verdict is applied
+                            // already, and only the feed entry needs it.
+                            if (const Stage2Record* record = stage2_cache_.find(message_id)) {
+                                apply_stage2(*record, std::nullopt, record->verdict());
+                            } else {
+                                queue_stage2(message_id, user_id, channel_id, page.text(row, 3), page.text(row, 4));
+                            }
+                        }
+                        if (stage2_) {
+                            stage2_->submit(stage2_submissions_);
+                        }
+                    };
+                } else {
+                    activity_.reset();
+                    std::tie(tail_specs[0], tail_specs[1]) = activity_specs(true);
+                }
+                tail_results = supabase_.fetch_all(tail_specs);
+            }
+            const QueryResult* messages_q = seed_from_rollups ? &tail_results[0] : &results[kMessagesQuery];
+            const QueryResult* reactions_q = seed_from_rollups ? &tail_results[1] : &results[kReactionsQuery];
+            std::vector<QueryResult> resync_results;
+            if (!full_sync && (!messages_q->ok || !reactions_q->ok)) {
+                // A rejected delta filter means the table no longer matches what the
+                // marks were taken from: rebuild both from a full pass.
+                full_sync = true;
+                activity_.reset();
+                auto full_specs = activity_specs(true);
+                resync_results = supabase_.fetch_all({std::move(full_specs.first), std::move(full_specs.second)});
+                messages_q = &resync_results[0];
+                reactions_q = &resync_results[1];
+            }
+            if (messages_q->ok && reactions_q->ok) {
+                if (full_sync) {
+                    activity_.mark_synced();
+                }
+                activity_joins_ = joins;
+                message_floor_ = activity_.message_mark();
+                reaction_floor_ = activity_.reaction_mark();
+            }
         }
+        results.resize(kMessagesQuery);
+        const QueryResult& users_q = results[kUsersQuery];
+        if (users_q.ok && !specs[kUsersQuery].reuse && event_log_.enabled()) {
+            for (size_t row = 0; row < users_q.size(); ++row) {
+                event_log_.note_user(users_q.integer(row, 0), users_q.text(row, 1), users_q.real(row, 2));
+            }
+        }
+        event_log_.flush();
+        last_results_ = std::move(results);
+        return build_snapshot(snap, error);
     }
 
-    bool load_from_db() {
-        const QueryResult users_q = query_supabase(
-            "users",
-            {"select=user_id,username,current_score,weekly_score", "order=current_score.desc", "limit=300"},
-            ".[] | [(.user_id|tostring), (.username // \"\"), (.current_score|tostring), (.weekly_score|tostring)] | @tsv"
-        );
+    // Everything but the activity fetch: the UI snapshot from the last poll's
+    // tables (last_results_) and activity_. Realtime pushes rebuild through here
+    // without touching the network.
+    bool build_snapshot(DashboardSnapshot& snap, std::string& error) {
+        ScopedPerfTimer build_timer(PerfStage::Build);
+        const std::vector<QueryResult>& results = last_results_;
+        // Lookups and orderings live only for this build; `snap` owns its data.
+        ScratchArena::Scope scratch(build_arena_);
+        std::pmr::memory_resource* const mem = scratch.resource();
+        std::pmr::unordered_map<long long, std::pmr::string> user_name_by_id(mem);
+
+        const QueryResult& users_q = results[kUsersQuery];
         if (!users_q.ok) {
-            last_error_ = "users query failed: " + users_q.error;
+            error = "users query failed: " + users_q.error;
             return false;
         }
 
-        members_.clear();
-        channels_.clear();
-        votes_.clear();
-        issues_.clear();
-        feed_.clear();
-        samples_.clear();
-        user_name_by_id_.clear();
-        channel_name_by_id_.clear();
+        // Pages arrive in user_id order; the member list is presented by score.
+        std::pmr::vector<size_t> user_order(users_q.size(), mem);
+        std::iota(user_order.begin(), user_order.end(), size_t{0});
+        std::stable_sort(user_order.begin(), user_order.end(), [&](size_t a, size_t b) {
+            return users_q.real(a, 2) > users_q.real(b, 2);
+        });
 
-        std::unordered_map<long long, size_t> member_idx_by_id;
-        for (const auto& row : users_q.rows) {
-            if (row.size() < 4) {
-                continue;
-            }
-            const long long uid = to_ll(row[0], 0);
+        std::pmr::unordered_map<long long, size_t> member_idx_by_id(mem);
+        member_idx_by_id.reserve(users_q.size());
+        user_name_by_id.reserve(users_q.size());
+        for (size_t row : user_order) {
+            const long long uid = users_q.integer(row, 0);
             if (uid == 0) {
                 continue;
             }
-            std::string username = row[1];
+            std::string username(users_q.text(row, 1));
             if (username.empty()) {
                 username = "user-" + std::to_string(uid);
             }
             Member m{};
+            m.user_id = uid;
             m.name = username;
-            m.cp = std::max(0, static_cast<int>(std::round(to_double(row[2], 0.0))));
+            m.cp = std::max(0, static_cast<int>(std::round(users_q.real(row, 2))));
             m.ts = 100;
             m.streak = 0;
             m.info = 0;
@@ -963,76 +6874,32 @@ private:
             m.misc = 0;
             m.online = false;
             m.votes_participated = 0;
-            members_.push_back(m);
-            member_idx_by_id[uid] = members_.size() - 1;
-            user_name_by_id_[uid] = username;
+            snap.members.push_back(m);
+            member_idx_by_id[uid] = snap.members.size() - 1;
+            user_name_by_id.emplace(uid, username);
         }
 
-        const QueryResult member_ts_q = query_supabase(
-            "members",
-            {"select=*", "limit=1000"},
-            ".[] | [((.user_id // .member_id // .discord_user_id // .id // 0)|tostring), ((.ts // .trust_score // .ts_score // .trust // 100)|tostring)] | @tsv"
-        );
-        members_table_available_ = member_ts_q.ok;
+        const QueryResult& member_ts_q = results[kMembersQuery];
+        snap.members_table_available = member_ts_q.ok;
         if (member_ts_q.ok) {
-            for (const auto& row : member_ts_q.rows) {
-                if (row.size() < 2) {
-                    continue;
-                }
-                const long long uid = to_ll(row[0], 0);
-                auto it = member_idx_by_id.find(uid);
+            for (size_t row = 0; row < member_ts_q.size(); ++row) {
+                auto it = member_idx_by_id.find(member_ts_q.integer(row, 0));
                 if (it == member_idx_by_id.end()) {
                     continue;
                 }
-                members_[it->second].ts = clampi(static_cast<int>(std::round(to_double(row[1], 100.0))), 0, 100);
+                snap.members[it->second].ts = clampi(static_cast<int>(std::round(member_ts_q.real(row, 1))), 0, 100);
             }
         }
 
-        const QueryResult channels_q = query_supabase(
-            "channels",
-            {"select=channel_id,name", "limit=3000"},
-            ".[] | [(.channel_id|tostring), (.name // \"\")] | @tsv"
-        );
-        if (channels_q.ok) {
-            for (const auto& row : channels_q.rows) {
-                if (row.size() < 2) {
-                    continue;
-                }
-                const long long cid = to_ll(row[0], 0);
-                if (cid == 0) {
-                    continue;
-                }
-                channel_name_by_id_[cid] = normalize_channel_label(row[1], cid);
-            }
-        }
+        const int today_serial = today_day_serial();
 
-        const QueryResult messages_q = query_supabase(
-            "messages",
-            {"select=message_id,user_id,channel_id,content,timestamp", "order=timestamp.desc", "limit=6000"},
-            ".[] | [(.message_id|tostring), (.user_id|tostring), (.channel_id|tostring), (.content // \"\"), (.timestamp // \"\")] | @tsv"
-        );
-
-        std::unordered_map<long long, long long> message_owner;
-        std::unordered_map<long long, int> channel_message_count;
-        std::unordered_map<long long, int> channel_message_count_month;
-        std::unordered_map<long long, int> channel_message_count_week;
-        std::unordered_map<long long, std::unordered_map<long long, int>> channel_user_counts;
-        std::unordered_map<long long, std::unordered_set<long long>> channel_active_users;
-        std::unordered_map<long long, std::set<int>> active_days_by_user;
-        std::unordered_map<long long, int> reaction_count_today;
-        std::map<int, int> daily_total;
-        std::map<int, int> daily_info;
-        std::map<int, int> daily_insight;
-        std::map<int, int> daily_vibe;
-        std::map<int, int> daily_ops;
-        std::map<int, int> pulse_total;
-
-        auto find_member = [&](long long uid) -> Member* {
-            auto it = member_idx_by_id.find(uid);
-            if (it == member_idx_by_id.end()) {
-                return nullptr;
-            }
-            return &members_[it->second];
+        auto user_label = [&](long long uid) {
+            auto it = user_name_by_id.find(uid);
+            return it != user_name_by_id.end() ? std::string(it->second) : ("user-" + std::to_string(uid));
+        };
+        auto channel_label = [&](long long cid) {
+            auto it = channel_name_by_id_.find(cid);
+            return normalize_channel_label(it != channel_name_by_id_.end() ? it->second : "", cid);
         };
 
         auto type_for_category = [](Category c) {
@@ -1046,119 +6913,38 @@ private:
             return std::string("MISC");
         };
 
-        const int today_serial = today_day_serial();
-        if (messages_q.ok) {
-            for (const auto& row : messages_q.rows) {
-                if (row.size() < 5) {
-                    continue;
-                }
-                const long long message_id = to_ll(row[0], 0);
-                const long long user_id = to_ll(row[1], 0);
-                const long long channel_id = to_ll(row[2], 0);
-                if (user_id == 0 || channel_id == 0 || message_id == 0) {
-                    continue;
-                }
-                const std::string channel_name = normalize_channel_label(
-                    channel_name_by_id_.count(channel_id) ? channel_name_by_id_[channel_id] : "",
-                    channel_id
-                );
-                const std::string content = row[3];
-                const std::optional<int> day = parse_day_serial(row[4]);
-                const RuleResult result = rule_based_classify({channel_name, content});
-                Member* member = find_member(user_id);
-                if (member) {
-                    switch (result.category) {
-                        case Category::Info: ++member->info; break;
-                        case Category::Insight: ++member->insight; break;
-                        case Category::Vibe: ++member->vibe; break;
-                        case Category::Ops: ++member->ops; break;
-                        case Category::Misc: ++member->misc; break;
-                    }
-                }
-
-                if (samples_.size() < 10 && !content.empty()) {
-                    samples_.push_back({channel_name, content});
-                }
-                if (feed_.size() < 14) {
-                    const std::string user_name = user_name_by_id_.count(user_id) ? user_name_by_id_[user_id] : ("user-" + std::to_string(user_id));
-                    const std::string message = !content.empty() ? fit(content, 44) : ("posted in " + channel_name);
-                    feed_.push_back({type_for_category(result.category), user_name, message});
-                }
-
-                message_owner[message_id] = user_id;
-                channel_message_count[channel_id] += 1;
-                channel_user_counts[channel_id][user_id] += 1;
-                channel_active_users[channel_id].insert(user_id);
-
-                if (day) {
-                    if (*day >= (today_serial - 29)) {
-                        channel_message_count_month[channel_id] += 1;
-                    }
-                    if (*day >= (today_serial - 6)) {
-                        channel_message_count_week[channel_id] += 1;
-                    }
-                    active_days_by_user[user_id].insert(*day);
-                    if (*day == today_serial && member) {
-                        member->online = true;
-                    }
-                    daily_total[*day] += 1;
-                    switch (result.category) {
-                        case Category::Info: daily_info[*day] += 1; break;
-                        case Category::Insight: daily_insight[*day] += 1; break;
-                        case Category::Vibe: daily_vibe[*day] += 1; break;
-                        case Category::Ops: daily_ops[*day] += 1; break;
-                        case Category::Misc: break;
-                    }
-                }
+        for (const auto& recent : activity_.recent_messages()) {
+            if (snap.samples.size() < 10 && !recent.content.empty()) {
+                snap.samples.push_back({channel_label(recent.channel_id), recent.content, recent.category, recent.stage2_percent});
             }
-        }
-
-        const QueryResult reactions_q = query_supabase(
-            "reactions",
-            {"select=message_id,user_id,created_at", "order=created_at.desc", "limit=6000"},
-            ".[] | [(.message_id|tostring), (.user_id|tostring), (.created_at // \"\")] | @tsv"
-        );
-        if (reactions_q.ok) {
-            for (const auto& row : reactions_q.rows) {
-                if (row.size() < 3) {
-                    continue;
-                }
-                const long long message_id = to_ll(row[0], 0);
-                const long long reactor_id = to_ll(row[1], 0);
-                if (reactor_id == 0) {
-                    continue;
-                }
-                Member* reactor = find_member(reactor_id);
-                if (reactor) {
-                    reactor->votes_participated += 1;
-                }
-                const std::optional<int> day = parse_day_serial(row[2]);
-                if (day) {
-                    active_days_by_user[reactor_id].insert(*day);
-                    if (*day == today_serial) {
-                        reaction_count_today[reactor_id] += 1;
-                        if (reactor) {
-                            reactor->online = true;
-                        }
-                    }
-                }
+            if (snap.feed.size() < 14) {
+                const std::string message = !recent.content.empty()
+                    ? fit(recent.content, 44)
+                    : ("posted in " + channel_label(recent.channel_id));
+                snap.feed.push_back({type_for_category(recent.category), user_label(recent.user_id), message});
             }
         }
 
         for (const auto& it : member_idx_by_id) {
-            const long long uid = it.first;
-            Member& member = members_[it.second];
-            const auto days_it = active_days_by_user.find(uid);
-            if (days_it == active_days_by_user.end() || days_it->second.empty()) {
+            const std::optional<uint32_t> user = activity_.find_user(it.first);
+            if (!user) {
                 continue;
             }
-            const std::set<int>& day_set = days_it->second;
-            int streak = 0;
-            int cursor = today_serial;
-            while (day_set.find(cursor) != day_set.end()) {
-                ++streak;
-                --cursor;
+            Member& member = snap.members[it.second];
+            member.info = activity_.category_count(*user, Category::Info);
+            member.insight = activity_.category_count(*user, Category::Insight);
+            member.vibe = activity_.category_count(*user, Category::Vibe);
+            member.ops = activity_.category_count(*user, Category::Ops);
+            member.misc = activity_.category_count(*user, Category::Misc);
+            member.votes_participated = activity_.reactions(*user);
+            const DayBitmap& days = activity_.active_days(*user);
+            if (days.empty()) {
+                continue;
             }
+            member.online = days.test(today_serial);
+            member.active_week = days.count(today_serial - 6, today_serial);
+            member.active_month = days.count(today_serial - 29, today_serial);
+            const int streak = days.run_ending(today_serial);
             member.streak = streak;
             if (streak >= 30) {
                 member.titles.push_back("Streak-30");
@@ -1170,169 +6956,152 @@ private:
             }
         }
 
-        const QueryResult pulse_q = query_supabase(
-            "analytics_daily_pulse",
-            {"select=day,total_messages", "order=day.desc", "limit=60"},
-            ".[] | [(.day|tostring), (.total_messages|tostring)] | @tsv"
-        );
+        const QueryResult& pulse_q = results[kPulseQuery];
         if (pulse_q.ok) {
-            for (const auto& row : pulse_q.rows) {
-                if (row.size() < 2) {
-                    continue;
-                }
-                const std::optional<int> day = parse_day_serial(row[0]);
+            for (size_t row = 0; row < pulse_q.size(); ++row) {
+                const std::optional<int> day = pulse_q.day(row, 0);
                 if (!day) {
                     continue;
                 }
-                pulse_total[*day] = to_int(row[1], 0);
+                snap.daily_pulse.push_back({*day, static_cast<int>(pulse_q.integer(row, 1))});
             }
+            std::sort(snap.daily_pulse.begin(), snap.daily_pulse.end());
         }
 
-        const QueryResult channel_leaders_q = query_supabase(
-            "analytics_channel_leader_user",
-            {"select=channel_id,username"},
-            ".[] | [(.channel_id|tostring), (.username // \"-\")] | @tsv"
-        );
-        std::unordered_map<long long, std::string> champion_name_by_channel;
+        const QueryResult& channel_leaders_q = results[kChannelLeadersQuery];
+        std::pmr::unordered_map<long long, std::string_view> champion_name_by_channel(mem);
         if (channel_leaders_q.ok) {
-            for (const auto& row : channel_leaders_q.rows) {
-                if (row.size() < 2) {
-                    continue;
-                }
-                const long long channel_id = to_ll(row[0], 0);
-                champion_name_by_channel[channel_id] = row[1].empty() ? "-" : row[1];
+            for (size_t row = 0; row < channel_leaders_q.size(); ++row) {
+                const std::string_view username = channel_leaders_q.text(row, 1);
+                champion_name_by_channel[channel_leaders_q.integer(row, 0)] = username.empty() ? "-" : username;
             }
         }
 
-        const QueryResult channel_ranking_q = query_supabase(
-            "analytics_channel_ranking",
-            {"select=channel_id,channel_name,total_messages,active_users", "order=total_messages.desc", "limit=120"},
-            ".[] | [(.channel_id|tostring), (.channel_name // \"\"), (.total_messages|tostring), (.active_users|tostring)] | @tsv"
-        );
+        const QueryResult& channel_ranking_q = results[kChannelRankingQuery];
         if (channel_ranking_q.ok) {
-            for (const auto& row : channel_ranking_q.rows) {
-                if (row.size() < 4) {
-                    continue;
-                }
-                const long long channel_id = to_ll(row[0], 0);
-                const std::string channel_name = normalize_channel_label(row[1], channel_id);
-                channels_.push_back({
+            for (size_t row = 0; row < channel_ranking_q.size(); ++row) {
+                const long long channel_id = channel_ranking_q.integer(row, 0);
+                const std::string channel_name = normalize_channel_label(std::string(channel_ranking_q.text(row, 1)), channel_id);
+                const std::optional<uint32_t> channel = activity_.find_channel(channel_id);
+                snap.channels.push_back({
                     channel_name,
-                    std::max(0, to_int(row[2], 0)),
-                    std::max(0, channel_message_count_month[channel_id]),
-                    std::max(0, channel_message_count_week[channel_id]),
-                    champion_name_by_channel.count(channel_id) ? champion_name_by_channel[channel_id] : "-",
-                    std::max(0, to_int(row[3], 0)),
+                    std::max(0, static_cast<int>(channel_ranking_q.integer(row, 2))),
+                    channel ? activity_.channel_daily(*channel).since(today_serial - 29) : 0,
+                    channel ? activity_.channel_daily(*channel).since(today_serial - 6) : 0,
+                    std::string(champion_name_by_channel.count(channel_id) ? champion_name_by_channel[channel_id] : "-"),
+                    std::max(0, static_cast<int>(channel_ranking_q.integer(row, 3))),
                     channel_weight(channel_name)
                 });
             }
         }
 
-        if (channels_.empty()) {
-            for (const auto& it : channel_message_count) {
-                const long long channel_id = it.first;
-                const std::string channel_name = normalize_channel_label(
-                    channel_name_by_id_.count(channel_id) ? channel_name_by_id_[channel_id] : "",
-                    channel_id
-                );
-                std::string champion = "-";
-                int top_count = 0;
-                auto uc_it = channel_user_counts.find(channel_id);
-                if (uc_it != channel_user_counts.end()) {
-                    for (const auto& kv : uc_it->second) {
-                        if (kv.second > top_count) {
-                            top_count = kv.second;
-                            champion = user_name_by_id_.count(kv.first) ? user_name_by_id_[kv.first] : ("user-" + std::to_string(kv.first));
-                        }
-                    }
-                }
-                channels_.push_back({
+        if (snap.channels.empty()) {
+            for (uint32_t channel = 0; channel < activity_.channel_count(); ++channel) {
+                const std::string channel_name = channel_label(activity_.channel_id(channel));
+                const std::optional<uint32_t> champion = activity_.channel_champion(channel);
+                const DayCounts& daily = activity_.channel_daily(channel);
+                snap.channels.push_back({
                     channel_name,
-                    std::max(0, it.second),
-                    std::max(0, channel_message_count_month[channel_id]),
-                    std::max(0, channel_message_count_week[channel_id]),
-                    champion,
-                    static_cast<int>(channel_active_users[channel_id].size()),
+                    std::max(0, activity_.channel_total(channel)),
+                    daily.since(today_serial - 29),
+                    daily.since(today_serial - 6),
+                    champion ? user_label(activity_.user_id(*champion)) : "-",
+                    activity_.channel_active_users(channel),
                     channel_weight(channel_name)
                 });
             }
-            std::sort(channels_.begin(), channels_.end(), [](const Channel& a, const Channel& b) {
+            std::sort(snap.channels.begin(), snap.channels.end(), [](const Channel& a, const Channel& b) {
                 return a.messages_total > b.messages_total;
             });
         }
 
-        const QueryResult votes_q = query_supabase(
-            "votes",
-            {"select=*", "limit=30"},
-            ".[] | [((.id // .vote_id // .proposal_id // 0)|tostring), ((.title // .name // \"(untitled)\")|tostring), ((.type // .vote_type // \"normal\")|tostring), ((.yes_vp // .yes_votes // .yes // 0)|tostring), ((.no_vp // .no_votes // .no // 0)|tostring), ((.voters // .voter_count // 0)|tostring), ((.total_eligible // .eligible_voters // .eligible // 0)|tostring), ((.days_left // .remaining_days // 0)|tostring)] | @tsv"
-        );
-        votes_table_available_ = votes_q.ok;
-        if (votes_q.ok) {
-            for (const auto& row : votes_q.rows) {
-                if (row.size() < 8) {
-                    continue;
+        // What-if basis: the channels listed members posted in, busiest first.
+        {
+            struct Cell {
+                uint32_t channel;
+                uint32_t member;
+                int base_cp;
+            };
+            std::pmr::vector<Cell> cells(mem);
+            std::pmr::vector<int> column_of(activity_.channel_count(), -1, mem);
+            activity_.for_each_channel_user([&](uint32_t channel, uint32_t user, int base_cp) {
+                auto it = member_idx_by_id.find(activity_.user_id(user));
+                if (it != member_idx_by_id.end() && base_cp > 0) {
+                    cells.push_back({channel, static_cast<uint32_t>(it->second), base_cp});
+                    column_of[channel] = 0;
+                }
+            });
+            std::pmr::vector<uint32_t> used(mem);
+            for (uint32_t channel = 0; channel < column_of.size(); ++channel) {
+                if (column_of[channel] == 0) {
+                    used.push_back(channel);
                 }
-                votes_.push_back({
-                    row[0],
-                    row[1],
-                    row[2],
-                    std::max(0, to_int(row[3], 0)),
-                    std::max(0, to_int(row[4], 0)),
-                    std::max(0, to_int(row[5], 0)),
-                    std::max(0, to_int(row[6], 0)),
-                    std::max(0, to_int(row[7], 0))
+            }
+            std::stable_sort(used.begin(), used.end(), [&](uint32_t a, uint32_t b) {
+                return activity_.channel_total(a) > activity_.channel_total(b);
+            });
+            ScoringBasis& basis = snap.scoring;
+            basis.member_count = snap.members.size();
+            for (uint32_t channel : used) {
+                column_of[channel] = static_cast<int>(basis.channels.size());
+                basis.channels.push_back(channel_label(activity_.channel_id(channel)));
+                basis.weights.push_back(profile_of(activity_.channel_id(channel)).weight);
+            }
+            basis.base_cp.assign(basis.channels.size() * basis.member_count, 0);
+            for (const Cell& cell : cells) {
+                basis.base_cp[static_cast<size_t>(column_of[cell.channel]) * basis.member_count + cell.member] = cell.base_cp;
+            }
+        }
+
+        const QueryResult& votes_q = results[kVotesQuery];
+        snap.votes_table_available = votes_q.ok;
+        if (votes_q.ok) {
+            auto count_at = [&](size_t row, size_t col) {
+                return std::max(0, static_cast<int>(votes_q.integer(row, col)));
+            };
+            for (size_t row = 0; row < votes_q.size(); ++row) {
+                snap.votes.push_back({
+                    std::string(votes_q.text(row, 0)),
+                    std::string(votes_q.text(row, 1)),
+                    std::string(votes_q.text(row, 2)),
+                    count_at(row, 3),
+                    count_at(row, 4),
+                    count_at(row, 5),
+                    count_at(row, 6),
+                    count_at(row, 7)
                 });
             }
         }
 
-        const QueryResult issues_q = query_supabase(
-            "issues",
-            {"select=*", "limit=50"},
-            ".[] | [((.id // .issue_id // 0)|tostring), ((.title // .name // \"(untitled)\")|tostring), ((.label // .type // \"-\")|tostring), ((.priority // \"medium\")|tostring), ((.status // \"open\")|tostring), ((.assignee // .owner // \"-\")|tostring)] | @tsv"
-        );
-        issues_table_available_ = issues_q.ok;
+        const QueryResult& issues_q = results[kIssuesQuery];
+        snap.issues_table_available = issues_q.ok;
         if (issues_q.ok) {
-            for (const auto& row : issues_q.rows) {
-                if (row.size() < 6) {
-                    continue;
-                }
-                issues_.push_back({
-                    std::max(0, to_int(row[0], 0)),
-                    row[1],
-                    row[2],
-                    row[3],
-                    row[4],
-                    row[5]
+            for (size_t row = 0; row < issues_q.size(); ++row) {
+                snap.issues.push_back({
+                    std::max(0, static_cast<int>(issues_q.integer(row, 0))),
+                    std::string(issues_q.text(row, 1)),
+                    std::string(issues_q.text(row, 2)),
+                    std::string(issues_q.text(row, 3)),
+                    std::string(issues_q.text(row, 4)),
+                    std::string(issues_q.text(row, 5))
                 });
             }
         }
 
-        total_hist_.assign(kHistoryWidth, 0);
-        info_hist_.assign(kHistoryWidth, 0);
-        insight_hist_.assign(kHistoryWidth, 0);
-        vibe_hist_.assign(kHistoryWidth, 0);
-        ops_hist_.assign(kHistoryWidth, 0);
-        for (int i = 0; i < kHistoryWidth; ++i) {
-            const int day = today_serial - (kHistoryWidth - 1 - i);
-            total_hist_[i] = pulse_total.count(day) ? pulse_total[day] : daily_total[day];
-            info_hist_[i] = daily_info[day];
-            insight_hist_[i] = daily_insight[day];
-            vibe_hist_[i] = daily_vibe[day];
-            ops_hist_[i] = daily_ops[day];
-        }
+        snap.series = activity_.series();
 
-        if (samples_.empty()) {
-            samples_.push_back({"#general", "No recent messages in DB. (messages table empty)"});
+        if (snap.samples.empty()) {
+            snap.samples.push_back({"#general", "No recent messages in DB. (messages table empty)", Category::Misc});
         }
-        if (feed_.empty()) {
-            feed_.push_back({"INFO", "system", "No recent activity records."});
+        if (snap.feed.empty()) {
+            snap.feed.push_back({"INFO", "system", "No recent activity records."});
         }
 
         std::vector<int> sprint_issue_ids;
-        for (size_t i = 0; i < issues_.size() && i < 3; ++i) {
-            sprint_issue_ids.push_back(issues_[i].id);
+        for (size_t i = 0; i < snap.issues.size() && i < 3; ++i) {
+            sprint_issue_ids.push_back(snap.issues[i].id);
         }
-        sprint_ = {
+        snap.sprint = {
             "Current Sprint",
             iso_date_from_serial(today_serial),
             iso_date_from_serial(today_serial + 13),
@@ -1340,96 +7109,523 @@ private:
             20
         };
 
-        db_ready_ = true;
-        using_mock_data_ = false;
-        data_status_ = "DB LIVE";
-        last_refresh_hms_ = now_hms();
-        last_error_.clear();
-        last_db_refresh_ = std::chrono::steady_clock::now();
+        snap.stage2_queue = stage2_ ? static_cast<int>(stage2_->backlog()) : -1;
+        snap.loading_tables = prefetch_tables_;
+        snap.refreshed_hms = now_hms();
         return true;
     }
 
+    void start_refresh_worker() {
+        refresh_requested_ = true;
+        refresh_worker_ = std::thread([this]() { refresh_worker_loop(); });
+    }
+
+    void stop_refresh_worker() {
+        {
+            std::lock_guard<std::mutex> lock(refresh_mutex_);
+            refresh_stop_ = true;
+        }
+        supabase_.cancel();
+        if (upstream_) {
+            upstream_->cancel();
+        }
+        refresh_cv_.notify_all();
+        if (refresh_worker_.joinable()) {
+            refresh_worker_.join();
+        }
+        if (realtime_) {
+            realtime_->stop();
+        }
+        if (stage2_) {
+            stage2_->stop();
+        }
+        if (member_activity_) {
+            member_activity_->stop();
+        }
+    }
+
+    // Manual `r`: wakes the worker. Requests made while a load is in flight are
+    // coalesced into a single follow-up load.
     void refresh_from_db(bool manual_trigger) {
+        {
+            std::lock_guard<std::mutex> lock(refresh_mutex_);
+            refresh_requested_ = true;
+            refresh_manual_ = refresh_manual_ || manual_trigger;
+        }
+        refresh_cv_.notify_all();
+    }
+
+    // Realtime feed thread. A (re)join asks for a poll at once so the delta
+    // closes the gap the feed left.
+    void on_realtime_event(RealtimeFeed::Event event) {
+        {
+            std::lock_guard<std::mutex> lock(refresh_mutex_);
+            if (event == RealtimeFeed::Event::Rows) {
+                realtime_pending_ = true;
+            } else {
+                refresh_requested_ = true;
+            }
+        }
+        refresh_cv_.notify_all();
+    }
+
+    // UI thread, on a page switch: the worker refreshes what the page shows if
+    // it is due.
+    void on_page_shown(int page) {
+        if (upstream_ || replay_) {
+            return;
+        }
+        visible_pages_ = page_bit(page);
+        {
+            std::lock_guard<std::mutex> lock(refresh_mutex_);
+            page_changed_ = true;
+        }
+        refresh_cv_.notify_all();
+    }
+
+    // Stage2 worker thread: verdicts are waiting in stage2_->take().
+    void on_stage2_verdicts() {
+        {
+            std::lock_guard<std::mutex> lock(refresh_mutex_);
+            stage2_pending_ = true;
+        }
+        refresh_cv_.notify_all();
+    }
+
+    void refresh_worker_loop() {
+        std::unique_lock<std::mutex> lock(refresh_mutex_);
+        // An upstream long poll is its own wait: re-poll at once unless it failed.
+        bool poll_again = false;
+        auto next_poll = std::chrono::steady_clock::now();
+        while (!refresh_stop_) {
+            // Realtime rows and Stage2 verdicts wake the worker between polls
+            // without moving the next one.
+            const bool woken = refresh_cv_.wait_until(lock, poll_again ? std::chrono::steady_clock::now() : next_poll, [this]() {
+                return refresh_stop_ || refresh_requested_ || realtime_pending_ || stage2_pending_ || page_changed_;
+            });
+            if (refresh_stop_) {
+                break;
+            }
+            // A page whose tables have gone stale off screen is polled for at once.
+            if (std::exchange(page_changed_, false) && visible_tables_due(visible_pages_)) {
+                refresh_requested_ = true;
+            }
+            if (woken && !refresh_requested_) {
+                const bool rows = std::exchange(realtime_pending_, false);
+                const bool verdicts = std::exchange(stage2_pending_, false);
+                lock.unlock();
+                std::unique_ptr<RefreshOutcome> outcome = ingest(rows, verdicts);
+                lock.lock();
+                if (outcome) {
+                    pending_outcome_ = std::move(outcome);
+                    outcome_ready_ = true;
+                    wake_ui();
+                }
+                continue;
+            }
+            const bool manual_trigger = refresh_manual_;
+            refresh_requested_ = false;
+            refresh_manual_ = false;
+            lock.unlock();
+
+            // An upstream long poll is mostly waiting; only a Supabase load shows
+            // as refreshing.
+            refresh_in_flight_ = !upstream_;
+            wake_ui();
+            RefreshOutcome outcome = build_refresh_outcome(manual_trigger);
+            refresh_in_flight_ = false;
+            poll_again = upstream_ && outcome.error.empty();
+            // Off-screen tables the first load skipped follow right after it.
+            next_poll = std::chrono::steady_clock::now() + std::chrono::seconds(prefetch_tables_ ? 0 : db_refresh_interval_sec_);
+
+            lock.lock();
+            pending_outcome_ = std::make_unique<RefreshOutcome>(std::move(outcome));
+            outcome_ready_ = true;
+            wake_ui();
+        }
+    }
+
+    void wake_ui() {
+        if (wake_pipe_[1] >= 0) {
+            const char byte = 1;
+            (void)!write(wake_pipe_[1], &byte, 1);
+        }
+    }
+
+    // Blocks until a key arrives, the worker wakes us, or the clock in the top
+    // bar is due to change.
+    void wait_for_event() {
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        const int ms_into_second = static_cast<int>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now).count() % 1000);
+        std::array<pollfd, 2> fds{};
+        fds[0] = {STDIN_FILENO, POLLIN, 0};
+        fds[1] = {wake_pipe_[0], POLLIN, 0};
+        const nfds_t count = wake_pipe_[0] >= 0 ? 2 : 1;
+        if (poll(fds.data(), count, 1000 - ms_into_second + 1) > 0 && count == 2 && (fds[1].revents & POLLIN)) {
+            std::array<char, 64> drain{};
+            while (read(wake_pipe_[0], drain.data(), drain.size()) > 0) {
+            }
+        }
+    }
+
+    RefreshOutcome build_refresh_outcome(bool manual_trigger) {
+        RefreshOutcome outcome;
+        if (upstream_) {
+            // Not cached locally: the serving instance keeps its own cache.
+            auto snap = std::make_unique<DashboardSnapshot>();
+            PerfRefreshScope perf_refresh;
+            const UpstreamClient::Poll poll = upstream_->poll(*snap, outcome.error);
+            if (poll == UpstreamClient::Poll::Updated) {
+                outcome.snapshot = std::move(snap);
+            }
+            outcome.unchanged = poll == UpstreamClient::Poll::Unchanged;
+            return outcome;
+        }
         const char* url = std::getenv("SUPABASE_URL");
         const char* key = std::getenv("SUPABASE_KEY");
         if (!url || !key || std::string(url).empty() || std::string(key).empty()) {
-            using_mock_data_ = false;
-            data_status_ = "DB ERROR";
-            last_error_ = manual_trigger
+            outcome.missing_credentials = true;
+            outcome.error = manual_trigger
                 ? "SUPABASE_URL / SUPABASE_KEY が未設定です。"
                 : "SUPABASE_URL / SUPABASE_KEY が未設定のため DB 接続できません。";
+            return outcome;
+        }
+
+        auto snap = std::make_unique<DashboardSnapshot>();
+        if (load_snapshot(*snap, outcome.error, manual_trigger)) {
+            // A first load that left tables out is not worth painting from on
+            // the next start; the prefetch right after it stores the whole one.
+            if (!snap->loading_tables) {
+                ScopedPerfTimer store_timer(PerfStage::CacheStore);
+                snapshot_cache_.store(*snap, activity_);
+            }
+            outcome.snapshot = std::move(snap);
+        }
+        return outcome;
+    }
+
+    // Folds what the feed has pushed and the verdicts Stage2 has returned, and
+    // rebuilds the snapshot from the last poll's tables; null when there is
+    // nothing to show yet. Before the first activity fetch realtime rows are
+    // dropped: that fetch still covers them.
+    std::unique_ptr<RefreshOutcome> ingest(bool rows, bool verdicts) {
+        bool changed = false;
+        {
+            ScopedPerfTimer fold_timer(PerfStage::Aggregate);
+            if (rows && realtime_) {
+                QueryResult messages;
+                QueryResult reactions;
+                realtime_->take(messages, reactions);
+                if ((messages.size() > 0 || reactions.size() > 0) && activity_joins_ && !last_results_.empty()) {
+                    fold_message_page(messages, message_floor_);
+                    fold_reaction_page(reactions, reaction_floor_);
+                    event_log_.flush();
+                    changed = true;
+                }
+            }
+            verdicts = verdicts && stage2_ && apply_stage2_verdicts();
+        }
+        if ((!changed && !verdicts) || last_results_.empty()) {
+            return nullptr;
+        }
+        auto outcome = std::make_unique<RefreshOutcome>();
+        auto snap = std::make_unique<DashboardSnapshot>();
+        if (!build_snapshot(*snap, outcome->error)) {
+            return nullptr;
+        }
+        // The next poll would store the moved counts too, but a quit before it
+        // would lose them: the verdicts are cached and never asked for again.
+        if (verdicts) {
+            ScopedPerfTimer store_timer(PerfStage::CacheStore);
+            snapshot_cache_.store(*snap, activity_);
+        }
+        outcome->snapshot = std::move(snap);
+        return outcome;
+    }
+
+    // Each verdict moves a message counted as Misc (when the aggregates still
+    // hold it) and is cached for the next fold of the same message.
+    bool apply_stage2_verdicts() {
+        const std::vector<Stage2Record> records = stage2_->take();
+        bool applied = false;
+        for (const Stage2Record& record : records) {
+            if (stage2_cache_.find(record.message_id)) {
+                continue;
+            }
+            stage2_cache_.add(record);
+            apply_stage2(record, record.time / 60, Category::Misc);
+            applied = true;
+        }
+        stage2_cache_.flush();
+        return applied;
+    }
+
+    // --replay: the dashboard as of `time`, from the log alone. The tables the
+    // log does not carry (members, votes, issues, analytics views) stay empty.
+    void seek_replay(int64_t time) {
+        replay_time_ = std::clamp(time, replay_->first_time(), replay_->last_time());
+        g_replay_now = replay_time_;
+        replay_->seek(replay_time_, activity_);
+        channel_name_by_id_.clear();
+        profile_by_channel_.clear();
+        replay_->for_each_channel([&](long long channel_id, std::string_view name) {
+            channel_name_by_id_[channel_id] = normalize_channel_label(std::string(name), channel_id);
+        });
+        last_results_.assign(kMessagesQuery, QueryResult());
+        QueryResult& users = last_results_[kUsersQuery];
+        users = QueryResult(users_spec().fields);
+        users.ok = true;
+        replay_->for_each_user_at(replay_time_, [&](long long user_id, std::string_view name, double score) {
+            users.set(0, std::to_string(user_id));
+            users.set(1, name);
+            users.set(2, format_double(score, 2));
+            users.commit_row();
+        });
+
+        DashboardSnapshot snap;
+        std::string error;
+        if (build_snapshot(snap, error)) {
+            snap.refreshed_hms = format_iso_utc(replay_time_ - replay_time_ % 60).substr(0, 16);
+            snap.refreshed_hms[10] = ' ';
+            apply_snapshot(snap);
+            ++data_generation_;
+        }
+    }
+
+    // UI thread: swaps a finished snapshot in. Cheap enough to call every frame.
+    void adopt_refresh_outcome() {
+        if (!outcome_ready_) {
+            return;
+        }
+        std::unique_ptr<RefreshOutcome> outcome;
+        {
+            std::lock_guard<std::mutex> lock(refresh_mutex_);
+            outcome = std::move(pending_outcome_);
+            outcome_ready_ = false;
+        }
+        if (!outcome || outcome->unchanged) {
+            return;
+        }
+        ++data_generation_;
+
+        if (!outcome->snapshot) {
+            last_error_ = outcome->error;
+            if (outcome->missing_credentials) {
+                using_mock_data_ = false;
+                data_status_ = "DB ERROR";
+            } else {
+                data_status_ = showing_cache_ ? "CACHED" : (db_ready_ ? "DB STALE" : "DB ERROR");
+            }
+            perf_stats().record_refresh_failure();
+            return;
+        }
+
+        apply_snapshot(*outcome->snapshot);
+        perf_stats().record_snapshot({
+            {"members", members_.size()},
+            {"channels", channels_.size()},
+            {"votes", votes_.size()},
+            {"issues", issues_.size()},
+            {"feed", feed_.size()},
+            {"samples", samples_.size()}
+        });
+        showing_cache_ = false;
+        data_status_ = upstream_ ? "UPSTREAM" : "DB LIVE";
+        last_error_.clear();
+        last_db_refresh_ = std::chrono::steady_clock::now();
+    }
+
+    void apply_snapshot(DashboardSnapshot& snap) {
+        ScopedPerfTimer apply_timer(PerfStage::Apply);
+        members_ = std::move(snap.members);
+        member_order_.update(members_);
+        index_members();
+        channels_ = std::move(snap.channels);
+        rebuild_channel_orders();
+        votes_ = std::move(snap.votes);
+        issues_ = std::move(snap.issues);
+        feed_ = std::move(snap.feed);
+        samples_ = std::move(snap.samples);
+        sprint_ = std::move(snap.sprint);
+        series_ = std::move(snap.series);
+        daily_pulse_ = std::move(snap.daily_pulse);
+        scoring_ = std::move(snap.scoring);
+        what_if_channel_ = std::min(what_if_channel_, scoring_.channels.empty() ? 0 : scoring_.channels.size() - 1);
+        rescore_what_if();
+        measure_display_widths();
+        members_table_available_ = snap.members_table_available;
+        votes_table_available_ = snap.votes_table_available;
+        issues_table_available_ = snap.issues_table_available;
+        loading_tables_ = snap.loading_tables;
+        stage2_queue_ = snap.stage2_queue;
+
+        db_ready_ = true;
+        using_mock_data_ = false;
+        last_refresh_hms_ = snap.refreshed_hms;
+    }
+
+    double what_if_weight(size_t channel) const {
+        auto it = what_if_weights_.find(scoring_.channels[channel]);
+        return it != what_if_weights_.end() ? it->second : scoring_.weights[channel];
+    }
+
+    void rescore_what_if() {
+        ++what_if_generation_;
+        if (!what_if_active_) {
+            return;
+        }
+        WhatIfScenario scenario{scoring_.weights, what_if_ts_scale_};
+        for (size_t ch = 0; ch < scoring_.channels.size(); ++ch) {
+            scenario.weights[ch] = what_if_weight(ch);
+        }
+        score_scenario(scoring_, members_, scenario, what_if_scores_);
+    }
+
+    void adjust_what_if_weight(double step) {
+        if (scoring_.channels.empty()) {
             return;
         }
+        const double weight = std::clamp(std::round((what_if_weight(what_if_channel_) + step) * 10.0) / 10.0, 0.0, 5.0);
+        what_if_weights_[scoring_.channels[what_if_channel_]] = weight;
+        rescore_what_if();
+    }
 
-        if (!load_from_db()) {
-            if (db_ready_) {
-                data_status_ = "DB STALE";
-            } else {
-                using_mock_data_ = false;
-                data_status_ = "DB ERROR";
-            }
+    // Table rows pad names every frame; measure them once per snapshot instead.
+    void measure_display_widths() {
+        for (Member& m : members_) {
+            m.name_width = display_width_utf8(m.name);
+        }
+        for (Channel& ch : channels_) {
+            ch.name_width = display_width_utf8(ch.name);
+            ch.champion_width = display_width_utf8(ch.champion);
         }
     }
 
-    void tick() {
-        const auto now = std::chrono::steady_clock::now();
-        if (now - last_db_refresh_ >= std::chrono::seconds(db_refresh_interval_sec_)) {
-            if (!load_from_db()) {
-                data_status_ = db_ready_ ? "DB STALE" : "DB ERROR";
-            }
+    // Members page: asks for the selected member's recent activity, and redraws
+    // the detail panel when an answer lands.
+    void follow_member_activity() {
+        if (!member_activity_) {
+            return;
         }
+        if (member_activity_->generation() != member_activity_generation_) {
+            member_activity_generation_ = member_activity_->generation();
+            ++member_view_generation_;
+        }
+        const std::vector<int>& sorted = sorted_member_indices();
+        if (page_ == 2 && !sorted.empty()) {
+            const int row = clampi(selected_member_row_, 0, static_cast<int>(sorted.size()) - 1);
+            member_activity_->request(members_[sorted[row]].user_id);
+        }
+    }
+
+    // The displayed state as a snapshot, for publishing in --serve mode.
+    DashboardSnapshot current_snapshot() const {
+        DashboardSnapshot snap;
+        snap.members = members_;
+        snap.channels = channels_;
+        snap.votes = votes_;
+        snap.issues = issues_;
+        snap.feed = feed_;
+        snap.samples = samples_;
+        snap.sprint = sprint_;
+        snap.series = series_;
+        snap.daily_pulse = daily_pulse_;
+        snap.scoring = scoring_;
+        snap.members_table_available = members_table_available_;
+        snap.votes_table_available = votes_table_available_;
+        snap.issues_table_available = issues_table_available_;
+        snap.stage2_queue = stage2_queue_;
+        snap.refreshed_hms = last_refresh_hms_;
+        return snap;
+    }
 
+    void tick() {
         // Mock animation branch is intentionally preserved but disabled.
         // if (using_mock_data_) {
-        //     auto push_rw = [&](std::vector<int>& hist, int lo, int hi, int delta) {
-        //         const int last = hist.empty() ? lo : hist.back();
-        //         std::uniform_int_distribution<int> move(-delta, delta);
-        //         int next = clampi(last + move(rng_), lo, hi);
-        //         hist.erase(hist.begin());
-        //         hist.push_back(next);
-        //     };
-        //     push_rw(total_hist_, 10, 80, 8);
-        //     push_rw(info_hist_, 2, 26, 3);
-        //     push_rw(insight_hist_, 2, 28, 3);
-        //     push_rw(vibe_hist_, 4, 34, 4);
-        //     push_rw(ops_hist_, 1, 18, 3);
+        //     std::uniform_int_distribution<int> category_d(0, static_cast<int>(kCategoryCount) - 1);
+        //     series_.add(now_epoch_minute(), static_cast<Category>(category_d(rng_)));
         // }
     }
 
-    std::vector<int> sorted_member_indices() const {
-        std::vector<int> idx(members_.size());
-        std::iota(idx.begin(), idx.end(), 0);
+    const std::vector<int>& sorted_member_indices() const {
+        return member_order_.order(sort_key_);
+    }
 
-        auto key_of = [&](const Member& m) {
-            switch (sort_key_) {
-                case SortKey::Cp: return static_cast<double>(m.cp);
-                case SortKey::Ts: return static_cast<double>(m.ts);
-                case SortKey::Vp: return static_cast<double>(calc_vp(m.cp));
-                case SortKey::Streak: return static_cast<double>(m.streak);
-                case SortKey::Info: return static_cast<double>(m.info);
-                case SortKey::Insight: return static_cast<double>(m.insight);
-                case SortKey::Vibe: return static_cast<double>(m.vibe);
-                case SortKey::Ops: return static_cast<double>(m.ops);
-            }
-            return static_cast<double>(m.cp);
-        };
+    void index_members() {
+        members_max_cp_ = 1;
+        for (const Member& m : members_) {
+            members_max_cp_ = std::max(members_max_cp_, m.cp);
+        }
+        member_names_.rebuild(members_);
+    }
+
+    void select_member_row(int row) {
+        selected_member_row_ = clampi(row, 0, std::max(0, static_cast<int>(members_.size()) - 1));
+    }
 
-        std::sort(idx.begin(), idx.end(), [&](int lhs, int rhs) {
-            const Member& a = members_[lhs];
-            const Member& b = members_[rhs];
-            double ka = key_of(a);
-            double kb = key_of(b);
-            if (ka == kb) {
-                return a.cp > b.cp;
+    // Selects the best-ranked (in the current sort) member whose name starts
+    // with `query`, or with the first such rank after `after` when given.
+    // Returns the number of matches.
+    int search_members(const std::string& query, std::optional<int> after = std::nullopt) {
+        const std::string prefix = to_lower(query);
+        if (prefix.empty()) {
+            return 0;
+        }
+        const std::vector<int>& sorted = sorted_member_indices();
+        std::vector<int> rank_of(sorted.size());
+        for (size_t row = 0; row < sorted.size(); ++row) {
+            rank_of[static_cast<size_t>(sorted[row])] = static_cast<int>(row);
+        }
+        int matches = 0;
+        int best = -1;
+        int first = -1;
+        member_names_.for_each_match(prefix, [&](int member) {
+            const int row = rank_of[static_cast<size_t>(member)];
+            ++matches;
+            if (first < 0 || row < first) {
+                first = row;
+            }
+            if (after && row > *after && (best < 0 || row < best)) {
+                best = row;
             }
-            return ka > kb;
         });
+        if (best < 0) {
+            best = first;  // no match past `after`: wrap around
+        }
+        if (best >= 0) {
+            select_member_row(best);
+        }
+        return matches;
+    }
 
-        return idx;
+    void handle_member_prompt_key(int ch) {
+        ++member_view_generation_;
+        const bool editing = member_prompt_ == MemberPrompt::Search;
+        if (ch == 27) {
+            member_prompt_ = MemberPrompt::None;
+        } else if (ch == '\n' || ch == '\r' || ch == KEY_ENTER) {
+            if (member_prompt_ == MemberPrompt::Rank && !member_prompt_text_.empty()) {
+                select_member_row(std::stoi(member_prompt_text_) - 1);
+            }
+            if (editing) {
+                member_search_ = member_prompt_text_;
+            }
+            member_prompt_ = MemberPrompt::None;
+        } else if (ch == KEY_BACKSPACE || ch == 127 || ch == 8) {
+            if (!member_prompt_text_.empty()) {
+                member_prompt_text_.pop_back();
+            }
+        } else if (editing ? (ch >= 0x20 && ch <= 0xFF) : (ch >= '0' && ch <= '9' && member_prompt_text_.size() < 7)) {
+            member_prompt_text_.push_back(static_cast<char>(ch));
+        }
+        if (editing && member_prompt_ == MemberPrompt::Search) {
+            member_search_matches_ = search_members(member_prompt_text_);
+        }
     }
 
-    int channel_messages_for_range(const Channel& ch) const {
-        switch (channel_activity_range_) {
+    static int channel_messages_in(const Channel& ch, ChannelActivityRange range) {
+        switch (range) {
             case ChannelActivityRange::All: return ch.messages_total;
             case ChannelActivityRange::Month: return ch.messages_month;
             case ChannelActivityRange::Week: return ch.messages_week;
@@ -1437,6 +7633,10 @@ private:
         return ch.messages_total;
     }
 
+    int channel_messages_for_range(const Channel& ch) const {
+        return channel_messages_in(ch, channel_activity_range_);
+    }
+
     std::string channel_range_label() const {
         switch (channel_activity_range_) {
             case ChannelActivityRange::All: return "TOTAL";
@@ -1446,44 +7646,84 @@ private:
         return "TOTAL";
     }
 
-    std::vector<const Channel*> sorted_channels_for_activity() const {
-        std::vector<const Channel*> ordered;
-        ordered.reserve(channels_.size());
-        for (const auto& ch : channels_) {
-            ordered.push_back(&ch);
+    void rebuild_channel_orders() {
+        for (int r = 0; r < kChannelActivityRangeCount; ++r) {
+            const auto range = static_cast<ChannelActivityRange>(r);
+            std::vector<int>& order = channel_orders_[static_cast<size_t>(r)];
+            order.resize(channels_.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](int a, int b) {
+                const Channel& lhs = channels_[static_cast<size_t>(a)];
+                const Channel& rhs = channels_[static_cast<size_t>(b)];
+                const int left = channel_messages_in(lhs, range);
+                const int right = channel_messages_in(rhs, range);
+                if (left != right) {
+                    return left > right;
+                }
+                if (lhs.messages_total != rhs.messages_total) {
+                    return lhs.messages_total > rhs.messages_total;
+                }
+                return lhs.name < rhs.name;
+            });
         }
-        std::sort(ordered.begin(), ordered.end(), [&](const Channel* lhs, const Channel* rhs) {
-            const int left = channel_messages_for_range(*lhs);
-            const int right = channel_messages_for_range(*rhs);
-            if (left != right) {
-                return left > right;
-            }
-            if (lhs->messages_total != rhs->messages_total) {
-                return lhs->messages_total > rhs->messages_total;
-            }
-            return lhs->name < rhs->name;
-        });
-        return ordered;
     }
 
-    void draw() {
-        erase();
+    const std::vector<int>& sorted_channels_for_activity() const {
+        return channel_orders_[static_cast<size_t>(channel_activity_range_)];
+    }
 
+    // Repaints only what changed: the top bar when its text differs, the
+    // footer on layout changes, panels whose inputs moved. doupdate() then
+    // sends just the resulting cell differences to the terminal.
+    void draw() {
+        const PerfClock::time_point frame_start = PerfClock::now();
+        const uint64_t frame_allocs = t_alloc_count;
         int h = 0;
         int w = 0;
         getmaxyx(stdscr, h, w);
+        if (h != layout_h_ || w != layout_w_) {
+            layout_h_ = h;
+            layout_w_ = w;
+            layout_dirty_ = true;
+        }
 
         if (h < kMinHeight || w < kMinWidth) {
-            draw_too_small(h, w);
-            refresh();
+            if (layout_dirty_) {
+                erase();
+                draw_too_small(h, w);
+                refresh();
+                invalidate_panels();
+                layout_dirty_ = false;
+            }
             return;
         }
 
-        draw_topbar(w);
-        draw_footer(h, w);
+        const bool relayout = layout_dirty_;
+        if (relayout) {
+            erase();
+            invalidate_panels();
+            draw_footer(h, w);
+            shown_topbar_.clear();
+            layout_dirty_ = false;
+        }
+        const bool exposed = relayout || page_ != shown_page_;
+        if (page_ != shown_page_) {
+            on_page_shown(page_);
+        }
+        shown_page_ = page_;
+
+        const std::string topbar = topbar_right();
+        if (exposed || topbar != shown_topbar_) {
+            move(0, 0);
+            clrtoeol();
+            draw_topbar(w, topbar);
+            shown_topbar_ = topbar;
+        }
+        wnoutrefresh(stdscr);
 
         const int content_y = 1;
         const int content_h = h - 3;
+        expose_panels_ = exposed;
 
         switch (page_) {
             case 1: draw_overview(content_y, content_h, w); break;
@@ -1491,10 +7731,64 @@ private:
             case 3: draw_channels(content_y, content_h, w); break;
             case 4: draw_governance(content_y, content_h, w); break;
             case 5: draw_issues(content_y, content_h, w); break;
+            case 6: draw_perf(content_y, content_h, w); break;
             default: draw_overview(content_y, content_h, w); break;
         }
 
-        refresh();
+        doupdate();
+        FramePerf& frame = frame_perf_[static_cast<size_t>(clampi(page_, 1, kPageCount) - 1)];
+        frame.time_us.add(elapsed_us(frame_start));
+        frame.allocs.add(static_cast<uint32_t>(t_alloc_count - frame_allocs));
+        perf_stats().record_frame(frame.time_us.last());
+    }
+
+    // Re-renders panel `id` into its cached window when its geometry or inputs
+    // changed; otherwise the window is only re-posted if the page was exposed.
+    template <typename Render>
+    void draw_panel(PanelId id, int y, int x, int h, int w, const PanelInputs& inputs, Render render) {
+        Panel& panel = panels_[id];
+        if (!panel.win || panel.y != y || panel.x != x || panel.h != h || panel.w != w) {
+            if (panel.win) {
+                delwin(panel.win);
+            }
+            panel = Panel{};
+            panel.win = newwin(h, w, y, x);
+            panel.y = y;
+            panel.x = x;
+            panel.h = h;
+            panel.w = w;
+            if (!panel.win) {
+                return;
+            }
+        }
+        if (!panel.valid || panel.inputs != inputs) {
+            werase(panel.win);
+            draw_target() = {panel.win, y, x};
+            render();
+            draw_target() = {};
+            panel.valid = true;
+            panel.inputs = inputs;
+        } else if (expose_panels_) {
+            touchwin(panel.win);
+        }
+        wnoutrefresh(panel.win);
+    }
+
+    PanelInputs data_inputs() const { return {data_generation_, 0, 0}; }
+
+    void invalidate_panels() {
+        for (auto& panel : panels_) {
+            panel.valid = false;
+        }
+    }
+
+    void destroy_panels() {
+        for (auto& panel : panels_) {
+            if (panel.win) {
+                delwin(panel.win);
+            }
+            panel = Panel{};
+        }
     }
 
     void draw_too_small(int h, int w) {
@@ -1506,13 +7800,32 @@ private:
         mvprintw(6, 2, "Resize and keep running, or press q to quit.");
     }
 
-    void draw_topbar(int w) {
-        const std::array<std::string, 5> tabs = {
+    std::string topbar_right() const {
+        std::string right = "comm0ns-cpp-tui [" + data_status_ + "] ";
+        if (!metrics_label_.empty()) {
+            right += metrics_label_ + " ";
+        }
+        if (realtime_) {
+            right += realtime_->live() ? "rt:live " : "rt:down ";
+        }
+        if (refresh_in_flight_) {
+            right += "refreshing... ";
+        }
+        right += now_hms();
+        if (!last_refresh_hms_.empty() && last_refresh_hms_ != "-") {
+            right += (replay_ ? "  at:" : "  ref:") + last_refresh_hms_;
+        }
+        return right;
+    }
+
+    void draw_topbar(int w, const std::string& right) {
+        const std::array<std::string, kPageCount> tabs = {
             "1:Overview",
             "2:Members",
             "3:Channels",
             "4:Governance",
-            "5:Issues"
+            "5:Issues",
+            "6:Perf"
         };
 
         tab_hits_.clear();
@@ -1529,10 +7842,6 @@ private:
             x += static_cast<int>(label.size()) + 1;
         }
 
-        std::string right = "comm0ns-cpp-tui [" + data_status_ + "] " + now_hms();
-        if (!last_refresh_hms_.empty() && last_refresh_hms_ != "-") {
-            right += "  ref:" + last_refresh_hms_;
-        }
         put_line(0, std::max(1, w - static_cast<int>(right.size()) - 2), static_cast<int>(right.size()), right, 2, true);
     }
 
@@ -1573,7 +7882,8 @@ private:
     }
 
     void draw_footer(int h, int w) {
-        const std::string left = "j/k:select  s:sort  a/m/w:ch-range  r:refresh  1-5:page  q:quit";
+        const std::string left = replay_ ? "h/l:-/+1h  H/L:-/+1d  j/k:select  s:sort  z:zoom  1-6:page  q:quit"
+                                         : "j/k:select  s:sort  a/m/w:ch-range  z:zoom  r:refresh  1-6:page  q:quit";
         const std::string right = "Design: Stage1/2/3 + CP*TS + VP(log2) + Vote/Issue/Titles";
         put_line(h - 1, 1, w - 2, left, 7, false);
         put_line(h - 1, std::max(1, w - static_cast<int>(right.size()) - 2), static_cast<int>(right.size()), right, 7, false);
@@ -1585,26 +7895,121 @@ private:
         const int left_w = (w * 2) / 3;
         const int right_w = w - left_w;
 
-        draw_box(y, 0, row1_h, left_w, " Activity Engine ", 2);
-        draw_box(y, left_w, row1_h, right_w, " Community Stats ", 3);
-        draw_box(y + row1_h, 0, row2_h, w / 2, " Live Feed ", 6);
-        draw_box(y + row1_h, w / 2, row2_h, w - w / 2, " Category + Rewards ", 4);
+        const long long now_minute = now_epoch_minute();
+        const PanelInputs activity_inputs = {
+            data_generation_,
+            static_cast<long long>(activity_zoom_),
+            ActivitySeries::bucket_of(zoom_resolution(activity_zoom_), now_minute)
+        };
+        draw_panel(kOverviewActivityPanel, y, 0, row1_h, left_w, activity_inputs, [&]() {
+            draw_box(y, 0, row1_h, left_w, std::string(" Activity Engine ") + zoom_label(activity_zoom_) + " ", 2);
+            draw_overview_activity(y + 1, 2, row1_h - 2, left_w - 4, now_minute);
+        });
+        draw_panel(kOverviewStatsPanel, y, left_w, row1_h, right_w, data_inputs(), [&]() {
+            draw_box(y, left_w, row1_h, right_w, " Community Stats ", 3);
+            draw_overview_stats(y + 1, left_w + 2, row1_h - 2, right_w - 4);
+        });
+        draw_panel(kOverviewFeedPanel, y + row1_h, 0, row2_h, w / 2, data_inputs(), [&]() {
+            draw_box(y + row1_h, 0, row2_h, w / 2, " Live Feed ", 6);
+            draw_overview_feed(y + row1_h + 1, 2, row2_h - 2, w / 2 - 4);
+        });
+        draw_panel(kOverviewCategoryPanel, y + row1_h, w / 2, row2_h, w - w / 2, data_inputs(), [&]() {
+            draw_box(y + row1_h, w / 2, row2_h, w - w / 2, " Category + Rewards ", 4);
+            draw_overview_category(y + row1_h + 1, w / 2 + 2, row2_h - 2, w - (w / 2) - 4);
+        });
+    }
+
+    static ActivitySeries::Resolution zoom_resolution(ActivityZoom zoom) {
+        switch (zoom) {
+            case ActivityZoom::Hour: return ActivitySeries::kMinutes;
+            case ActivityZoom::Day: return ActivitySeries::kHours;
+            case ActivityZoom::Month: return ActivitySeries::kDays;
+        }
+        return ActivitySeries::kHours;
+    }
+
+    static int zoom_buckets(ActivityZoom zoom) {
+        switch (zoom) {
+            case ActivityZoom::Hour: return 60;
+            case ActivityZoom::Day: return 24;
+            case ActivityZoom::Month: return 30;
+        }
+        return 24;
+    }
+
+    static const char* zoom_label(ActivityZoom zoom) {
+        switch (zoom) {
+            case ActivityZoom::Hour: return "1h";
+            case ActivityZoom::Day: return "24h";
+            case ActivityZoom::Month: return "30d";
+        }
+        return "24h";
+    }
+
+    // Message totals per bucket of the current zoom. Day buckets prefer the
+    // server's analytics_daily_pulse figure when it has one.
+    std::vector<int> activity_totals(long long now_minute) const {
+        const ActivitySeries::Resolution resolution = zoom_resolution(activity_zoom_);
+        const int buckets = zoom_buckets(activity_zoom_);
+        std::vector<int> totals = series_.window(resolution, now_minute, buckets, std::nullopt);
+        if (resolution == ActivitySeries::kDays) {
+            const long long today = ActivitySeries::bucket_of(resolution, now_minute);
+            for (int i = 0; i < buckets; ++i) {
+                const int day = static_cast<int>(today - (buckets - 1 - i));
+                auto it = std::lower_bound(daily_pulse_.begin(), daily_pulse_.end(), std::make_pair(day, std::numeric_limits<int>::min()));
+                if (it != daily_pulse_.end() && it->first == day) {
+                    totals[i] = it->second;
+                }
+            }
+        }
+        return totals;
+    }
 
-        draw_overview_activity(y + 1, 2, row1_h - 2, left_w - 4);
-        draw_overview_stats(y + 1, left_w + 2, row1_h - 2, right_w - 4);
-        draw_overview_feed(y + row1_h + 1, 2, row2_h - 2, w / 2 - 4);
-        draw_overview_category(y + row1_h + 1, w / 2 + 2, row2_h - 2, w - (w / 2) - 4);
+    // One block character per column, scaled to the busiest column.
+    static std::string sparkline(const std::vector<int>& values, int width) {
+        static const std::array<const char*, 9> levels = {" ", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+        const int n = static_cast<int>(values.size());
+        std::vector<int> columns(static_cast<size_t>(std::max(0, width)), 0);
+        for (int c = 0; c < width && n > 0; ++c) {
+            const int lo = c * n / width;
+            const int hi = std::max(lo + 1, (c + 1) * n / width);
+            for (int i = lo; i < hi && i < n; ++i) {
+                columns[c] += values[i];
+            }
+        }
+        const int peak = columns.empty() ? 0 : *std::max_element(columns.begin(), columns.end());
+        std::string out;
+        for (int v : columns) {
+            const int level = (peak <= 0 || v <= 0) ? 0 : std::max(1, static_cast<int>(std::round(8.0 * v / peak)));
+            out += levels[level];
+        }
+        return out;
     }
 
-    void draw_overview_activity(int y, int x, int h, int w) {
+    void draw_overview_activity(int y, int x, int h, int w, long long now_minute) {
         if (h <= 0) return;
 
+        const ActivitySeries::Resolution resolution = zoom_resolution(activity_zoom_);
+        const int buckets = zoom_buckets(activity_zoom_);
+        const std::vector<int> totals = activity_totals(now_minute);
+        const int total = std::accumulate(totals.begin(), totals.end(), 0);
+        auto category_total = [&](Category c) {
+            const std::vector<int> counts = series_.window(resolution, now_minute, buckets, c);
+            return std::accumulate(counts.begin(), counts.end(), 0);
+        };
+        const int info = category_total(Category::Info);
+        const int insight = category_total(Category::Insight);
+        const int vibe = category_total(Category::Vibe);
+        const int ops = category_total(Category::Ops);
+        // One column per bucket when the panel is wide enough.
+        const int width = clampi(w - 24, 8, buckets);
+
         int line = y;
-        put_line(line++, x, w, "TOTAL    [" + bar(total_hist_.back(), 80, 26) + "] " + std::to_string(total_hist_.back()) + " msg/h", 3);
-        put_line(line++, x, w, "INFO     [" + bar(info_hist_.back(), 26, 26) + "] " + std::to_string(info_hist_.back()), 2);
-        put_line(line++, x, w, "INSIGHT  [" + bar(insight_hist_.back(), 28, 26) + "] " + std::to_string(insight_hist_.back()), 9);
-        put_line(line++, x, w, "VIBE     [" + bar(vibe_hist_.back(), 34, 26) + "] " + std::to_string(vibe_hist_.back()), 6);
-        put_line(line++, x, w, "OPS      [" + bar(ops_hist_.back(), 18, 26) + "] " + std::to_string(ops_hist_.back()), 4);
+        put_line(line++, x, w, "TOTAL    [" + sparkline(totals, width) + "] " + std::to_string(total) + " msg/" + zoom_label(activity_zoom_), 3);
+        put_line(line++, x, w, "INFO     [" + bar(info, total, width) + "] " + std::to_string(info), 2);
+        put_line(line++, x, w, "INSIGHT  [" + bar(insight, total, width) + "] " + std::to_string(insight), 9);
+        put_line(line++, x, w, "VIBE     [" + bar(vibe, total, width) + "] " + std::to_string(vibe), 6);
+        put_line(line++, x, w, "OPS      [" + bar(ops, total, width) + "] " + std::to_string(ops), 4);
 
         if (line < y + h) {
             put_line(line++, x, w, "", 1);
@@ -1612,14 +8017,21 @@ private:
 
         int stage1 = 0;
         int stage2 = 0;
+        int verdicts = 0;
         int low_conf = 0;
         for (const auto& sample : samples_) {
-            RuleResult r = rule_based_classify(sample);
+            const RuleResult r = sample_result(sample);
             if (r.stage == 1) ++stage1; else ++stage2;
+            if (sample.stage2_percent >= 0) ++verdicts;
             if (r.confidence > 0.0 && r.confidence < 0.60) ++low_conf;
         }
 
-        put_line(line++, x, w, "Pipeline: Stage1=" + std::to_string(stage1) + "  Stage2Queue=" + std::to_string(stage2), 1);
+        if (stage2_queue_ >= 0) {
+            put_line(line++, x, w, "Pipeline: Stage1=" + std::to_string(stage1) + "  Stage2=" + std::to_string(verdicts) +
+                                   "  Stage2Queue=" + std::to_string(stage2_queue_), 1);
+        } else {
+            put_line(line++, x, w, "Pipeline: Stage1=" + std::to_string(stage1) + "  Stage2Queue=" + std::to_string(stage2), 1);
+        }
         if (line < y + h) {
             put_line(line++, x, w, "Review queue (<0.60 conf): " + std::to_string(low_conf), 4);
         }
@@ -1724,15 +8136,24 @@ private:
         const int left_w = (w * 3) / 5;
         const int right_w = w - left_w;
 
-        draw_box(y, 0, h, left_w, " Members Table ", 6);
-        draw_box(y, left_w, h, right_w, " Selected Member ", 2);
+        // The table clamps the selection, so it renders before the detail panel
+        // and the detail keys off the clamped row.
+        draw_panel(kMembersTablePanel, y, 0, h, left_w, members_view_inputs(), [&]() {
+            draw_box(y, 0, h, left_w, " Members Table ", 6);
+            draw_members_table(y + 1, 2, h - 2, left_w - 4);
+        });
+        draw_panel(kMemberDetailPanel, y, left_w, h, right_w, members_view_inputs(), [&]() {
+            draw_box(y, left_w, h, right_w, " Selected Member ", 2);
+            draw_member_detail(y + 1, left_w + 2, h - 2, right_w - 4);
+        });
+    }
 
-        draw_members_table(y + 1, 2, h - 2, left_w - 4);
-        draw_member_detail(y + 1, left_w + 2, h - 2, right_w - 4);
+    PanelInputs members_view_inputs() const {
+        return {data_generation_, selected_member_row_, static_cast<long long>(sort_key_), member_view_generation_};
     }
 
     void draw_members_table(int y, int x, int h, int w) {
-        const auto sorted = sorted_member_indices();
+        const std::vector<int>& sorted = sorted_member_indices();
         const int row_count = static_cast<int>(sorted.size());
         selected_member_row_ = clampi(selected_member_row_, 0, std::max(0, row_count - 1));
         member_row_hits_.clear();
@@ -1765,7 +8186,7 @@ private:
 
         auto row_line = [&](const Member& m, int vp, int cp_pct) -> std::string {
             return pad_right_display(m.online ? "*" : ".", col_on) + " " +
-                   pad_right_display(m.name, col_name) + " " +
+                   pad_right_display(m.name, col_name, m.name_width) + " " +
                    pad_left_display(std::to_string(m.cp), col_cp) + " " +
                    pad_left_display(std::to_string(m.ts), col_ts) + " " +
                    pad_left_display(std::to_string(vp), col_vp) + " " +
@@ -1777,34 +8198,47 @@ private:
                    pad_left_display(std::to_string(cp_pct), col_cpp);
         };
 
-        put_line(y, x, w, "Sort: " + sort_name(sort_key_) + "    Keys: s cycle, j/k select", 7);
+        if (member_prompt_ == MemberPrompt::Search) {
+            put_line(y, x, w, fit("/" + member_prompt_text_ + "_  " + std::to_string(member_search_matches_) + " match" +
+                                  (member_search_matches_ == 1 ? "" : "es") + "  (Enter: keep, Esc: close)", w), 4, true);
+        } else if (member_prompt_ == MemberPrompt::Rank) {
+            put_line(y, x, w, fit("rank: " + member_prompt_text_ + "_  of " + std::to_string(row_count) + "  (Enter: jump, Esc: close)", w), 4, true);
+        } else if (row_count > h - 2) {
+            put_line(y, x, w, fit("Sort: " + sort_name(sort_key_) + "  " + std::to_string(selected_member_row_ + 1) + "/" +
+                                  std::to_string(row_count) + "  Keys: s sort, j/k PgUp/PgDn, / search, : rank", w), 7);
+        } else {
+            put_line(y, x, w, "Sort: " + sort_name(sort_key_) + "    Keys: s cycle, j/k select", 7);
+        }
         put_line(y + 1, x, w, header_line(), 7, true);
 
-        int max_cp = 1;
-        for (const auto& m : members_) {
-            max_cp = std::max(max_cp, m.cp);
+        // Scroll just enough to keep the selection in view.
+        const int table_y = y + 2;
+        const int rows_avail = std::max(1, h - 2);
+        member_page_rows_ = rows_avail;
+        if (selected_member_row_ < member_view_top_) {
+            member_view_top_ = selected_member_row_;
+        } else if (selected_member_row_ >= member_view_top_ + rows_avail) {
+            member_view_top_ = selected_member_row_ - rows_avail + 1;
         }
+        member_view_top_ = clampi(member_view_top_, 0, std::max(0, row_count - rows_avail));
 
-        int table_y = y + 2;
-        const int rows_avail = h - 2;
-        for (int i = 0; i < rows_avail && i < row_count; ++i) {
-            const Member& m = members_[sorted[i]];
-            const bool selected = (i == selected_member_row_);
+        for (int i = 0; i < rows_avail && member_view_top_ + i < row_count; ++i) {
+            const int row = member_view_top_ + i;
+            const Member& m = members_[sorted[row]];
+            const bool selected = (row == selected_member_row_);
             if (selected) {
-                attron(COLOR_PAIR(8));
-                mvhline(table_y + i, x, ' ', w);
-                attroff(COLOR_PAIR(8));
+                fill_line(table_y + i, x, w, 8);
             }
 
             const int vp = calc_vp(m.cp);
-            const int cp_pct = static_cast<int>(std::round((static_cast<double>(m.cp) / max_cp) * 100.0));
+            const int cp_pct = static_cast<int>(std::round((static_cast<double>(m.cp) / members_max_cp_) * 100.0));
             put_line(table_y + i, x, w, fit(row_line(m, vp, cp_pct), w), selected ? 8 : 1, false);
-            member_row_hits_.push_back({table_y + i, x, x + std::max(0, w - 1), i});
+            member_row_hits_.push_back({table_y + i, x, x + std::max(0, w - 1), row});
         }
     }
 
     void draw_member_detail(int y, int x, int h, int w) {
-        const auto sorted = sorted_member_indices();
+        const std::vector<int>& sorted = sorted_member_indices();
         if (sorted.empty()) return;
 
         selected_member_row_ = clampi(selected_member_row_, 0, static_cast<int>(sorted.size()) - 1);
@@ -1813,7 +8247,8 @@ private:
         int line = y;
         put_line(line++, x, w, m.name + std::string(m.online ? " (online)" : " (offline)"), 2, true);
         put_line(line++, x, w, "CP=" + std::to_string(m.cp) + "  TS=" + std::to_string(m.ts) + "  VP=" + std::to_string(calc_vp(m.cp)), 3);
-        put_line(line++, x, w, "Effective VP=" + std::to_string(calc_effective_vp(m)) + "  streak=" + std::to_string(m.streak) + "d", 4);
+        put_line(line++, x, w, "Effective VP=" + std::to_string(calc_effective_vp(m)) + "  streak=" + std::to_string(m.streak) + "d" +
+                 "  active=" + std::to_string(m.active_week) + "/7d " + std::to_string(m.active_month) + "/30d", 4);
 
         if (!m.titles.empty() && line < y + h) {
             std::string all = "Titles: ";
@@ -1838,27 +8273,56 @@ private:
         const int vp = calc_vp(m.cp);
         put_line(line++, x, w, "VP calc: floor(log2(" + std::to_string(m.cp) + "+1))+1 = " + std::to_string(vp), 7);
         put_line(line++, x, w, "effVP : floor(" + std::to_string(vp) + "*" + std::to_string(m.ts) + "/100) = " + std::to_string(calc_effective_vp(m)), 7);
+
+        if (!member_activity_ || m.user_id == 0 || line + 1 >= y + h) {
+            return;
+        }
+        put_line(line++, x, w, "", 1);
+        const MemberActivity* activity = member_activity_->find(m.user_id);
+        if (!activity) {
+            put_line(line++, x, w, "Recent messages: loading...", 7);
+            return;
+        }
+        std::string reactions = "Recent reactions: " + std::to_string(activity->reacted.size());
+        if (!activity->reacted.empty()) {
+            reactions += "  (latest " + age_label(activity->reacted.front()) + " ago)";
+        }
+        put_line(line++, x, w, fit(reactions + (activity->ok ? "" : "  [fetch failed]"), w), activity->ok ? 7 : 5);
+        for (const MemberActivity::Post& post : activity->messages) {
+            if (line >= y + h) {
+                break;
+            }
+            const ChannelProfile& profile = channel_profile(post.channel);
+            const Category category = classify_stage1(profile.ops, post.content);
+            const std::string type = category_name(category).substr(0, 4);
+            std::ostringstream oss;
+            oss << std::setw(3) << age_label(post.timestamp) << " " << std::left << std::setw(4) << type << " "
+                << std::right << std::setw(4) << format_double(calc_effective_cp(category, profile, m.ts), 1) << " "
+                << post.channel << " " << post.content;
+            put_line(line++, x, w, fit(oss.str(), w), color_for_feed(type));
+        }
     }
 
     void draw_channels(int y, int h, int w) {
         const int left_w = w / 2;
         const int right_w = w - left_w;
 
-        draw_box(y, 0, h, left_w, " Channel Activity ", 3);
-        draw_box(y, left_w, h, right_w, " Classification + Commands ", 9);
-
-        draw_channels_left(y + 1, 2, h - 2, left_w - 4);
-        draw_channels_right(y + 1, left_w + 2, h - 2, right_w - 4);
+        draw_panel(kChannelsLeftPanel, y, 0, h, left_w, {data_generation_, static_cast<long long>(channel_activity_range_), 0}, [&]() {
+            draw_box(y, 0, h, left_w, " Channel Activity ", 3);
+            draw_channels_left(y + 1, 2, h - 2, left_w - 4);
+        });
+        draw_panel(kChannelsRightPanel, y, left_w, h, right_w, data_inputs(), [&]() {
+            draw_box(y, left_w, h, right_w, " Classification + Commands ", 9);
+            draw_channels_right(y + 1, left_w + 2, h - 2, right_w - 4);
+        });
     }
 
     void draw_channels_left(int y, int x, int h, int w) {
         channel_range_hits_.clear();
-        const auto ordered_channels = sorted_channels_for_activity();
+        const std::vector<int>& ordered_channels = sorted_channels_for_activity();
 
-        int max_msg = 1;
-        for (const Channel* ch : ordered_channels) {
-            max_msg = std::max(max_msg, channel_messages_for_range(*ch));
-        }
+        // Busiest first, so the head holds the maximum.
+        const int max_msg = std::max(1, ordered_channels.empty() ? 0 : channel_messages_for_range(channels_[ordered_channels.front()]));
 
         const int col_ch = 12;
         const int col_msg = 5;
@@ -1880,12 +8344,12 @@ private:
 
         auto row_line = [&](const Channel& ch) -> std::string {
             const int messages = channel_messages_for_range(ch);
-            return pad_right_display(ch.name, col_ch) + " " +
+            return pad_right_display(ch.name, col_ch, ch.name_width) + " " +
                    "[" + bar(messages, max_msg, bar_w) + "] " +
                    pad_left_display(std::to_string(messages), col_msg) + " " +
                    "A:" + pad_left_display(std::to_string(ch.active_users), col_active) + " " +
                    "W:" + pad_left_display(format_double(ch.weight, 1), col_weight) + " " +
-                   "C:" + pad_right_display(ch.champion, col_champ);
+                   "C:" + pad_right_display(ch.champion, col_champ, ch.champion_width);
         };
 
         int line = y;
@@ -1914,10 +8378,11 @@ private:
         if (line < y + h) {
             put_line(line++, x, w, fit(header_line(), w), 7, true);
         }
-        for (const Channel* ch : ordered_channels) {
+        for (int index : ordered_channels) {
             if (line >= y + h) break;
-            int color = (ch->weight > 1.0) ? 3 : ((ch->weight < 1.0) ? 7 : 1);
-            put_line(line++, x, w, fit(row_line(*ch), w), color);
+            const Channel& ch = channels_[static_cast<size_t>(index)];
+            int color = (ch.weight > 1.0) ? 3 : ((ch.weight < 1.0) ? 7 : 1);
+            put_line(line++, x, w, fit(row_line(ch), w), color);
         }
 
         if (line < y + h) put_line(line++, x, w, "", 1);
@@ -1925,6 +8390,15 @@ private:
         if (line < y + h) put_line(line++, x, w, "VC points: +2 per 10min (cap configurable)", 7);
     }
 
+    // A table the first load left for the prefetch, not yet arrived.
+    bool table_loading(QueryIndex table) const {
+        return (loading_tables_ >> table) & 1u;
+    }
+
+    std::string table_state(bool available, QueryIndex table) const {
+        return available ? "READY" : table_loading(table) ? "LOADING" : "PENDING";
+    }
+
     void draw_channels_right(int y, int x, int h, int w) {
         const int col_channel = 12;
         const int col_cat = 7;
@@ -1959,7 +8433,7 @@ private:
 
         for (const auto& sample : samples_) {
             if (line >= y + h) break;
-            RuleResult r = rule_based_classify(sample);
+            const RuleResult r = sample_result(sample);
             put_line(line++, x, w, fit(sample_row(sample, r), w), (r.stage == 1 ? 2 : 4));
         }
 
@@ -1973,17 +8447,17 @@ private:
         if (line < y + h) put_line(line++, x, w, "", 1);
         if (line < y + h) {
             put_line(line++, x, w,
-                fit(pad_right_display("members.ts", 14) + ": " + (members_table_available_ ? std::string("READY") : std::string("PENDING")), w),
+                fit(pad_right_display("members.ts", 14) + ": " + table_state(members_table_available_, kMembersQuery), w),
                 7);
         }
         if (line < y + h) {
             put_line(line++, x, w,
-                fit(pad_right_display("votes", 14) + ": " + (votes_table_available_ ? std::string("READY") : std::string("PENDING")), w),
+                fit(pad_right_display("votes", 14) + ": " + table_state(votes_table_available_, kVotesQuery), w),
                 7);
         }
         if (line < y + h) {
             put_line(line++, x, w,
-                fit(pad_right_display("issues", 14) + ": " + (issues_table_available_ ? std::string("READY") : std::string("PENDING")), w),
+                fit(pad_right_display("issues", 14) + ": " + table_state(issues_table_available_, kIssuesQuery), w),
                 7);
         }
     }
@@ -1992,20 +8466,24 @@ private:
         const int left_w = (w * 3) / 5;
         const int right_w = w - left_w;
 
-        draw_box(y, 0, h, left_w, " Votes ", 9);
-        draw_box(y, left_w, h, right_w, " VP Distribution ", 4);
-
-        draw_votes(y + 1, 2, h - 2, left_w - 4);
-        draw_vp(y + 1, left_w + 2, h - 2, right_w - 4);
+        draw_panel(kVotesPanel, y, 0, h, left_w, data_inputs(), [&]() {
+            draw_box(y, 0, h, left_w, " Votes ", 9);
+            draw_votes(y + 1, 2, h - 2, left_w - 4);
+        });
+        draw_panel(kVpPanel, y, left_w, h, right_w, {data_generation_, what_if_generation_, 0}, [&]() {
+            draw_box(y, left_w, h, right_w, " VP Distribution ", 4);
+            draw_vp(y + 1, left_w + 2, h - 2, right_w - 4);
+        });
     }
 
     void draw_votes(int y, int x, int h, int w) {
         int line = y;
         if (votes_.empty()) {
-            const std::string msg = votes_table_available_
-                ? "No active votes in DB."
+            const bool loading = table_loading(kVotesQuery);
+            const std::string msg = votes_table_available_ ? "No active votes in DB."
+                : loading ? "Loading votes..."
                 : "votes table is not available (PENDING: create votes schema).";
-            put_line(line++, x, w, fit(msg, w), votes_table_available_ ? 7 : 4, true);
+            put_line(line++, x, w, fit(msg, w), votes_table_available_ || loading ? 7 : 4, true);
             return;
         }
         for (const auto& v : votes_) {
@@ -2038,8 +8516,13 @@ private:
 
     void draw_vp(int y, int x, int h, int w) {
         int line = y;
-        for (const auto& m : members_) {
+        const bool what_if = what_if_active_ && what_if_scores_.size() == members_.size();
+        if (what_if) {
+            draw_what_if_summary(line, x, y + h, w);
+        }
+        for (size_t i = 0; i < members_.size(); ++i) {
             if (line >= y + h) break;
+            const Member& m = members_[i];
             const int vp = calc_vp(m.cp);
             const int evp = calc_effective_vp(m);
             std::ostringstream oss;
@@ -2048,18 +8531,64 @@ private:
                 << " VP[" << bar(vp, 6, 6, '=') << "] " << vp
                 << " eff=" << evp
                 << " TS=" << m.ts;
-            put_line(line++, x, w, fit(oss.str(), w), m.online ? 1 : 7);
+            int color = m.online ? 1 : 7;
+            if (what_if) {
+                const ScenarioScore& score = what_if_scores_[i];
+                oss << "  -> " << score.vp << "/" << score.effective_vp;
+                if (score.effective_vp != evp) {
+                    oss << " (" << std::showpos << score.effective_vp - evp << std::noshowpos << ")";
+                    color = score.effective_vp > evp ? 3 : 5;
+                }
+            }
+            put_line(line++, x, w, fit(oss.str(), w), color);
         }
 
         if (line < y + h) put_line(line++, x, w, "", 1);
+        if (what_if_active_) {
+            if (line < y + h) put_line(line++, x, w, fit("e:off  [/]:channel  +/-:weight  </>:TS  0:reset", w), 7);
+            return;
+        }
         if (line < y + h) put_line(line++, x, w, "VP formula : floor(log2(cumulativeEffectiveCP+1))+1", 7);
         if (line < y + h) put_line(line++, x, w, "effectiveVP: floor(VP * TS/100), min 1", 7);
         if (line < y + h) put_line(line++, x, w, "Safety valve: if 50-66% in major vote, branch proposal allowed", 7);
+        if (line < y + h) put_line(line++, x, w, "e: what-if (channel weights / TS)", 7);
+    }
+
+    void draw_what_if_summary(int& line, int x, int end, int w) {
+        std::ostringstream head;
+        head << "What-if ";
+        if (scoring_.channels.empty()) {
+            head << "(no per-channel activity loaded)";
+        } else {
+            head << "[" << (what_if_channel_ + 1) << "/" << scoring_.channels.size() << "] "
+                 << scoring_.channels[what_if_channel_] << " "
+                 << format_double(scoring_.weights[what_if_channel_], 1) << "->" << format_double(what_if_weight(what_if_channel_), 1);
+        }
+        head << "  TS x" << format_double(what_if_ts_scale_, 2);
+        if (line < end) put_line(line++, x, w, fit(head.str(), w), 4, true);
+
+        int before = 0;
+        int after = 0;
+        int up = 0;
+        int down = 0;
+        for (size_t i = 0; i < members_.size(); ++i) {
+            const int evp = calc_effective_vp(members_[i]);
+            before += evp;
+            after += what_if_scores_[i].effective_vp;
+            up += what_if_scores_[i].effective_vp > evp;
+            down += what_if_scores_[i].effective_vp < evp;
+        }
+        const std::string totals = "effVP total " + std::to_string(before) + " -> " + std::to_string(after) +
+                                   "  up " + std::to_string(up) + "  down " + std::to_string(down);
+        if (line < end) put_line(line++, x, w, fit(totals, w), 7);
+        if (line < end) put_line(line++, x, w, "", 1);
     }
 
     void draw_issues(int y, int h, int w) {
-        draw_box(y, 0, h, w, " Issue + Sprint Tracking ", 5);
-        draw_issues_content(y + 1, 2, h - 2, w - 4);
+        draw_panel(kIssuesPanel, y, 0, h, w, data_inputs(), [&]() {
+            draw_box(y, 0, h, w, " Issue + Sprint Tracking ", 5);
+            draw_issues_content(y + 1, 2, h - 2, w - 4);
+        });
     }
 
     void draw_issues_content(int y, int x, int h, int w) {
@@ -2076,10 +8605,11 @@ private:
         put_line(line++, x, w, "OPEN=" + std::to_string(open) + "  IN-PROGRESS=" + std::to_string(prog) +
                                "  REVIEW=" + std::to_string(review) + "  TOTAL=" + std::to_string(issues_.size()), 1, true);
         if (issues_.empty() && line < y + h) {
-            const std::string msg = issues_table_available_
-                ? "No issues in DB."
+            const bool loading = table_loading(kIssuesQuery);
+            const std::string msg = issues_table_available_ ? "No issues in DB."
+                : loading ? "Loading issues..."
                 : "issues table is not available (PENDING: create issues schema).";
-            put_line(line++, x, w, fit(msg, w), issues_table_available_ ? 7 : 4, true);
+            put_line(line++, x, w, fit(msg, w), issues_table_available_ || loading ? 7 : 4, true);
         }
 
         if (line < y + h) {
@@ -2125,7 +8655,115 @@ private:
         if (line < y + h) put_line(line++, x, w, "Docs +10 | design review +5", 1);
     }
 
+    // Page 6. Redrawn when a refresh lands or a stage sample arrives, and once
+    // a second for the frame/RSS figures.
+    void draw_perf(int y, int h, int w) {
+        const int left_w = (w * 3) / 5;
+        const int right_w = w - left_w;
+        const PanelInputs inputs = {data_generation_, static_cast<long long>(perf_stats().generation()),
+                                    static_cast<long long>(std::time(nullptr))};
+        const PerfReport report = perf_stats().report();
+
+        draw_panel(kPerfFetchPanel, y, 0, h, left_w, inputs, [&]() {
+            draw_box(y, 0, h, left_w, " Fetch (per endpoint) ", 2);
+            draw_perf_fetch(report, y + 1, 2, h - 2, left_w - 4);
+        });
+        draw_panel(kPerfRuntimePanel, y, left_w, h, right_w, inputs, [&]() {
+            draw_box(y, left_w, h, right_w, " Runtime ", 6);
+            draw_perf_runtime(report, y + 1, left_w + 2, h - 2, right_w - 4);
+        });
+    }
+
+    static std::string perf_ms(uint32_t us) {
+        return format_double(static_cast<double>(us) / 1000.0, 1);
+    }
+
+    void draw_perf_fetch(const PerfReport& report, int y, int x, int h, int w) {
+        int line = y;
+        const int col_name = std::max(12, w - 46);
+        auto row = [&](const std::string& name, const std::string& req, const std::string& err,
+                       const std::string& p50, const std::string& p99, const std::string& rows, const std::string& kib) {
+            return pad_right_display(name, col_name) + " " + pad_left_display(req, 6) + " " + pad_left_display(err, 4) + " " +
+                   pad_left_display(p50, 8) + " " + pad_left_display(p99, 8) + " " + pad_left_display(rows, 8) + " " +
+                   pad_left_display(kib, 6);
+        };
+
+        put_line(line++, x, w, "Latency per request (keyset page), over the last " +
+                 std::to_string(SampleWindow::kSamples) + " requests", 7);
+        put_line(line++, x, w, row("ENDPOINT", "REQ", "ERR", "p50 ms", "p99 ms", "ROWS", "KiB"), 7, true);
+        if (report.endpoints.empty()) {
+            put_line(line++, x, w, "No requests yet.", 7);
+            return;
+        }
+        uint64_t rows_total = 0;
+        uint64_t bytes_total = 0;
+        uint64_t unchanged_total = 0;
+        for (const auto& [endpoint, e] : report.endpoints) {
+            rows_total += e.rows;
+            bytes_total += e.bytes;
+            unchanged_total += e.unchanged;
+            if (line >= y + h - 2) {
+                continue;
+            }
+            put_line(line++, x, w, row(endpoint, std::to_string(e.requests), std::to_string(e.errors),
+                                       perf_ms(e.latency_us.percentile(50)), perf_ms(e.latency_us.percentile(99)),
+                                       std::to_string(e.rows), std::to_string((e.bytes + 1023) / 1024)),
+                     e.errors ? 5 : 1);
+        }
+        if (line < y + h) put_line(line++, x, w, "", 1);
+        if (line < y + h) {
+            put_line(line++, x, w, "ROWS/KiB: latest refresh  total=" + std::to_string(rows_total) + " rows / " +
+                     std::to_string((bytes_total + 1023) / 1024) + " KiB  refreshes=" + std::to_string(report.refreshes) +
+                     "  unchanged=" + std::to_string(unchanged_total), 7);
+        }
+    }
+
+    void draw_perf_runtime(const PerfReport& report, int y, int x, int h, int w) {
+        int line = y;
+        auto cells = [](const std::string& name, const std::string& a, const std::string& b, const std::string& c,
+                        const std::string& d) {
+            return pad_right_display(name, 12) + " " + pad_left_display(a, 8) + " " + pad_left_display(b, 8) + " " +
+                   pad_left_display(c, 8) + " " + pad_left_display(d, 8);
+        };
+
+        put_line(line++, x, w, cells("STAGE", "last ms", "p50 ms", "p99 ms", "samples"), 7, true);
+        for (size_t i = 0; i < kPerfStageCount && line < y + h; ++i) {
+            const SampleWindow& stage = report.stages[i];
+            put_line(line++, x, w, cells(perf_stage_name(static_cast<PerfStage>(i)), perf_ms(stage.last()),
+                                         perf_ms(stage.percentile(50)), perf_ms(stage.percentile(99)),
+                                         std::to_string(stage.count())), stage.count() ? 1 : 7);
+        }
+        if (line < y + h) put_line(line++, x, w, "parse/aggregate: one sample per refresh, summed over fetch threads", 7);
+
+        if (line < y + h) put_line(line++, x, w, "", 1);
+        if (line < y + h) put_line(line++, x, w, cells("FRAME", "p50 ms", "p99 ms", "alloc50", "alloc99"), 7, true);
+        static const std::array<const char*, kPageCount> pages = {"overview", "members", "channels", "governance", "issues", "perf"};
+        for (size_t i = 0; i < frame_perf_.size() && line < y + h; ++i) {
+            const FramePerf& frame = frame_perf_[i];
+            if (frame.time_us.count() == 0) {
+                continue;
+            }
+            put_line(line++, x, w, cells(pages[i], perf_ms(frame.time_us.percentile(50)), perf_ms(frame.time_us.percentile(99)),
+                                         std::to_string(frame.allocs.percentile(50)), std::to_string(frame.allocs.percentile(99))), 1);
+        }
+
+        if (line < y + h) put_line(line++, x, w, "", 1);
+        if (line < y + h) {
+            put_line(line++, x, w, "RSS " + format_double(static_cast<double>(current_rss_kb()) / 1024.0, 1) + " MiB  peak " +
+                     format_double(static_cast<double>(peak_rss_kb()) / 1024.0, 1) + " MiB", 3);
+        }
+        if (line < y + h) {
+            const AllocTotals allocs = alloc_totals();
+            put_line(line++, x, w, "heap allocs " + std::to_string(allocs.count) + "  (" + std::to_string(allocs.bytes >> 20) +
+                     " MiB requested)", 7);
+        }
+    }
+
     void handle_key(int ch, bool& running) {
+        if (page_ == 2 && member_prompt_ != MemberPrompt::None) {
+            handle_member_prompt_key(ch);
+            return;
+        }
         switch (ch) {
             case 'q':
             case 'Q':
@@ -2136,22 +8774,56 @@ private:
             case '3': page_ = 3; break;
             case '4': page_ = 4; break;
             case '5': page_ = 5; break;
+            case '6': page_ = 6; break;
             case 'j':
             case KEY_DOWN:
                 if (page_ == 2) {
-                    selected_member_row_ = clampi(selected_member_row_ + 1, 0, static_cast<int>(members_.size()) - 1);
+                    select_member_row(selected_member_row_ + 1);
+                }
+                break;
+            case KEY_NPAGE:
+            case KEY_PPAGE:
+                if (page_ == 2) {
+                    select_member_row(selected_member_row_ + (ch == KEY_NPAGE ? member_page_rows_ : -member_page_rows_));
+                }
+                break;
+            case KEY_HOME:
+            case 'g':
+                if (page_ == 2) {
+                    select_member_row(0);
+                }
+                break;
+            case KEY_END:
+            case 'G':
+                if (page_ == 2) {
+                    select_member_row(static_cast<int>(members_.size()) - 1);
+                }
+                break;
+            case '/':
+            case ':':
+                if (page_ == 2) {
+                    member_prompt_ = ch == '/' ? MemberPrompt::Search : MemberPrompt::Rank;
+                    member_prompt_text_.clear();
+                    member_search_matches_ = 0;
+                    ++member_view_generation_;
+                }
+                break;
+            case 'n':
+            case 'N':
+                if (page_ == 2 && !member_search_.empty()) {
+                    member_search_matches_ = search_members(member_search_, selected_member_row_);
                 }
                 break;
             case 'k':
             case KEY_UP:
                 if (page_ == 2) {
-                    selected_member_row_ = clampi(selected_member_row_ - 1, 0, static_cast<int>(members_.size()) - 1);
+                    select_member_row(selected_member_row_ - 1);
                 }
                 break;
             case 's':
             case 'S':
                 if (page_ == 2) {
-                    sort_key_ = static_cast<SortKey>((static_cast<int>(sort_key_) + 1) % 8);
+                    sort_key_ = static_cast<SortKey>((static_cast<int>(sort_key_) + 1) % kSortKeyCount);
                 }
                 break;
             case 'a':
@@ -2172,13 +8844,77 @@ private:
                     channel_activity_range_ = ChannelActivityRange::Week;
                 }
                 break;
+            case 'z':
+            case 'Z':
+                if (page_ == 1) {
+                    activity_zoom_ = static_cast<ActivityZoom>((static_cast<int>(activity_zoom_) + 1) % 3);
+                }
+                break;
             case 'r':
             case 'R':
-                refresh_from_db(true);
+                if (!replay_) {
+                    refresh_from_db(true);
+                }
+                break;
+            case 'h':
+            case 'l':
+            case 'H':
+            case 'L':
+            case KEY_LEFT:
+            case KEY_RIGHT:
+            case KEY_SLEFT:
+            case KEY_SRIGHT:
+                if (replay_) {
+                    const int64_t step = (ch == 'H' || ch == 'L' || ch == KEY_SLEFT || ch == KEY_SRIGHT) ? 86400 : 3600;
+                    const bool back = ch == 'h' || ch == 'H' || ch == KEY_LEFT || ch == KEY_SLEFT;
+                    seek_replay(replay_time_ + (back ? -step : step));
+                }
+                break;
+            case 'e':
+            case 'E':
+                if (page_ == 4) {
+                    what_if_active_ = !what_if_active_;
+                    rescore_what_if();
+                }
+                break;
+            case '[':
+            case ']':
+                if (page_ == 4 && what_if_active_ && !scoring_.channels.empty()) {
+                    const size_t n = scoring_.channels.size();
+                    what_if_channel_ = (what_if_channel_ + (ch == ']' ? 1 : n - 1)) % n;
+                    ++what_if_generation_;
+                }
+                break;
+            case '+':
+            case '=':
+            case '-':
+                if (page_ == 4 && what_if_active_) {
+                    adjust_what_if_weight(ch == '-' ? -0.1 : 0.1);
+                }
+                break;
+            case '<':
+            case ',':
+            case '>':
+            case '.':
+                if (page_ == 4 && what_if_active_) {
+                    const double step = (ch == '<' || ch == ',') ? -0.05 : 0.05;
+                    what_if_ts_scale_ = std::clamp(std::round((what_if_ts_scale_ + step) * 20.0) / 20.0, 0.5, 2.0);
+                    rescore_what_if();
+                }
+                break;
+            case '0':
+                if (page_ == 4 && what_if_active_) {
+                    what_if_weights_.clear();
+                    what_if_ts_scale_ = 1.0;
+                    rescore_what_if();
+                }
                 break;
             case KEY_MOUSE:
                 handle_mouse();
                 break;
+            case KEY_RESIZE:
+                layout_dirty_ = true;
+                break;
             default:
                 break;
         }
@@ -2187,8 +8923,139 @@ private:
 
 }  // namespace
 
-int main() {
-    DashboardApp app;
+// bench/pipeline_bench.cpp includes this file with its own main().
+#ifndef COMM0NS_TUI_NO_MAIN
+namespace {
+
+constexpr const char* kUsage =
+    "usage: comm0ns_tui [--metrics-listen [HOST:]PORT] [--realtime] [--serve [HOST:]PORT | --upstream URL | --replay FILE]\n"
+    "  --metrics-listen [HOST:]PORT  serve Prometheus metrics on http://HOST:PORT/metrics\n"
+    "  --serve [HOST:]PORT           headless: load from Supabase once and publish snapshots\n"
+    "                                on http://HOST:PORT/snapshot for --upstream clients\n"
+    "  --upstream URL                follow a --serve instance instead of querying Supabase\n"
+    "  --realtime                    take messages/reactions INSERTs from Supabase Realtime;\n"
+    "                                the other tables keep polling\n"
+    "  --replay FILE                 browse an event log offline (h/l, H/L move the clock);\n"
+    "                                logs are kept as events-*.log next to the snapshot cache\n"
+    "  HOST defaults to 127.0.0.1; nothing listens unless asked.\n";
+
+struct CliOptions {
+    bool help = false;
+    std::string metrics_host;
+    int metrics_port = 0;  // 0: no metrics endpoint
+    std::string serve_host;
+    int serve_port = 0;  // 0: interactive TUI
+    std::string upstream_url;
+    std::string replay_path;
+    bool realtime = false;
+};
+
+bool parse_listen_address(const std::string& value, std::string& host, int& port) {
+    const size_t colon = value.rfind(':');
+    host = colon == std::string::npos ? "127.0.0.1" : value.substr(0, colon);
+    const std::string port_text = colon == std::string::npos ? value : value.substr(colon + 1);
+    const auto [end, ec] = std::from_chars(port_text.data(), port_text.data() + port_text.size(), port);
+    return ec == std::errc() && end == port_text.data() + port_text.size() && port > 0 && port <= 65535 && !host.empty();
+}
+
+bool parse_cli(int argc, char** argv, CliOptions& options, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            options.help = true;
+            continue;
+        }
+        if (arg == "--realtime") {
+            options.realtime = true;
+            continue;
+        }
+        // --flag VALUE or --flag=VALUE
+        const size_t eq = arg.find('=');
+        const std::string flag = arg.substr(0, eq);
+        if (flag != "--metrics-listen" && flag != "--serve" && flag != "--upstream" && flag != "--replay") {
+            error = "unknown option: " + arg;
+            return false;
+        }
+        std::string value;
+        if (eq != std::string::npos) {
+            value = arg.substr(eq + 1);
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        } else {
+            error = flag + " needs a value";
+            return false;
+        }
+
+        if (flag == "--upstream") {
+            if (value.rfind("http://", 0) != 0 && value.rfind("https://", 0) != 0) {
+                error = "--upstream needs an http(s):// URL: " + value;
+                return false;
+            }
+            options.upstream_url = value;
+        } else if (flag == "--replay") {
+            options.replay_path = value;
+        } else if (!parse_listen_address(value, flag == "--serve" ? options.serve_host : options.metrics_host,
+                                         flag == "--serve" ? options.serve_port : options.metrics_port)) {
+            error = "invalid " + flag + " address: " + value;
+            return false;
+        }
+    }
+    if (options.realtime && !options.upstream_url.empty()) {
+        error = "--realtime talks to Supabase; an --upstream client does not";
+        return false;
+    }
+    if (!options.replay_path.empty() && (options.realtime || options.serve_port || !options.upstream_url.empty())) {
+        error = "--replay reads a local log; it does not combine with --realtime, --serve or --upstream";
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    CliOptions options;
+    std::string error;
+    if (!parse_cli(argc, argv, options, error)) {
+        std::fprintf(stderr, "comm0ns_tui: %s\n%s", error.c_str(), kUsage);
+        return 2;
+    }
+    if (options.help) {
+        std::fputs(kUsage, stdout);
+        return 0;
+    }
+
+    MetricsServer metrics;
+    if (options.metrics_port && !metrics.start(options.metrics_host, options.metrics_port, error)) {
+        std::fprintf(stderr, "comm0ns_tui: %s\n", error.c_str());
+        return 1;
+    }
+    if (options.serve_port) {
+        SnapshotServer server;
+        if (!server.start(options.serve_host, options.serve_port, error)) {
+            std::fprintf(stderr, "comm0ns_tui: %s\n", error.c_str());
+            return 1;
+        }
+        std::fprintf(stderr, "comm0ns_tui: serving snapshots on http://%s/snapshot\n", server.endpoint().c_str());
+        DashboardApp app(options.upstream_url, options.realtime);
+        app.serve(server);
+        return 0;
+    }
+    std::unique_ptr<EventReplay> replay;
+    if (!options.replay_path.empty()) {
+        replay = std::make_unique<EventReplay>();
+        if (!replay->open(options.replay_path, error)) {
+            std::fprintf(stderr, "comm0ns_tui: %s\n", error.c_str());
+            return 1;
+        }
+        if (replay->dropped_count() > 0) {
+            std::fprintf(stderr, "comm0ns_tui: %s: skipped %zu messages with no logged channel\n",
+                         options.replay_path.c_str(), replay->dropped_count());
+        }
+    }
+    DashboardApp app(options.upstream_url, options.realtime, std::move(replay));
+    app.set_metrics_endpoint(metrics.endpoint());
     app.run();
     return 0;
 }
+#endif
@@ -0,0 +1,134 @@
+-- Activity Rollups Migration
+-- Run this in Supabase SQL Editor
+--
+-- Per-day message / reaction counts by category, so the C++ TUI can seed a full
+-- sync from a few thousand rollup rows instead of downloading every message.
+-- Each view covers rows timestamped before `through` (the time of its last
+-- refresh); the TUI then reads messages / reactions from `through` onwards.
+
+-- ============================================
+-- Function: stage1_category
+-- TUI の Stage1 ルール（comm0ns_cpp_tui/src/main.cpp の classify_stage1）と同じ分類
+-- 片方を変えたらもう片方も合わせること
+-- ============================================
+CREATE OR REPLACE FUNCTION stage1_category(content TEXT, channel_name TEXT)
+RETURNS TEXT AS $$
+    SELECT CASE
+        WHEN COALESCE(content, '') ~* 'https?://' THEN 'info'
+        WHEN LOWER(CASE WHEN LEFT(channel_name, 1) = '#' THEN channel_name ELSE '#' || COALESCE(channel_name, '') END)
+             IN ('#ops', '#governance', '#announcements', '#sprint') THEN 'ops'
+        -- visible ASCII characters (0x21-0x7E)
+        WHEN LENGTH(REGEXP_REPLACE(COALESCE(content, ''), '[^!-~]', '', 'g')) < 5 THEN 'vibe'
+        WHEN OCTET_LENGTH(COALESCE(content, '')) > 200 THEN 'insight'
+        ELSE 'misc'
+    END;
+$$ LANGUAGE sql IMMUTABLE;
+
+-- Days follow the database TimeZone, as the timestamps PostgREST renders do.
+DROP MATERIALIZED VIEW IF EXISTS analytics_activity_minutes;
+DROP MATERIALIZED VIEW IF EXISTS analytics_reaction_rollup;
+DROP MATERIALIZED VIEW IF EXISTS analytics_activity_rollup;
+
+-- ============================================
+-- View: analytics_activity_rollup
+-- ユーザー × チャンネル × 日 ごとのカテゴリ別メッセージ数
+-- ============================================
+CREATE MATERIALIZED VIEW analytics_activity_rollup AS
+WITH cutoff AS (
+    SELECT NOW() AS through
+),
+classified AS (
+    SELECT
+        m.timestamp::date AS day,
+        m.user_id,
+        m.channel_id,
+        stage1_category(m.content, c.name) AS category
+    FROM messages m
+    CROSS JOIN cutoff
+    LEFT JOIN channels c ON m.channel_id = c.channel_id
+    WHERE m.timestamp < cutoff.through
+)
+SELECT
+    ROW_NUMBER() OVER (ORDER BY day, user_id, channel_id) AS row_id,
+    day,
+    user_id,
+    channel_id,
+    COUNT(*) FILTER (WHERE category = 'info') AS info,
+    COUNT(*) FILTER (WHERE category = 'insight') AS insight,
+    COUNT(*) FILTER (WHERE category = 'vibe') AS vibe,
+    COUNT(*) FILTER (WHERE category = 'ops') AS ops,
+    COUNT(*) FILTER (WHERE category = 'misc') AS misc,
+    (SELECT through FROM cutoff) AS through
+FROM classified
+GROUP BY day, user_id, channel_id;
+
+-- ============================================
+-- View: analytics_reaction_rollup
+-- ユーザー × 日 ごとのリアクション数
+-- ============================================
+CREATE MATERIALIZED VIEW analytics_reaction_rollup AS
+WITH cutoff AS (
+    SELECT NOW() AS through
+)
+SELECT
+    ROW_NUMBER() OVER (ORDER BY r.created_at::date, r.user_id) AS row_id,
+    r.created_at::date AS day,
+    r.user_id,
+    COUNT(*) AS reactions,
+    cutoff.through
+FROM reactions r
+CROSS JOIN cutoff
+WHERE r.created_at < cutoff.through
+GROUP BY r.created_at::date, r.user_id, cutoff.through;
+
+-- ============================================
+-- View: analytics_activity_minutes
+-- 直近48時間の分単位カテゴリ別メッセージ数（TUI の分・時間グラフ用）
+-- ============================================
+CREATE MATERIALIZED VIEW analytics_activity_minutes AS
+WITH cutoff AS (
+    SELECT NOW() AS through
+),
+classified AS (
+    SELECT
+        DATE_TRUNC('minute', m.timestamp) AS minute,
+        stage1_category(m.content, c.name) AS category
+    FROM messages m
+    CROSS JOIN cutoff
+    LEFT JOIN channels c ON m.channel_id = c.channel_id
+    WHERE m.timestamp >= cutoff.through - INTERVAL '48 hours'
+      AND m.timestamp < cutoff.through
+)
+SELECT
+    minute,
+    COUNT(*) FILTER (WHERE category = 'info') AS info,
+    COUNT(*) FILTER (WHERE category = 'insight') AS insight,
+    COUNT(*) FILTER (WHERE category = 'vibe') AS vibe,
+    COUNT(*) FILTER (WHERE category = 'ops') AS ops,
+    COUNT(*) FILTER (WHERE category = 'misc') AS misc,
+    (SELECT through FROM cutoff) AS through
+FROM classified
+GROUP BY minute;
+
+-- ============================================
+-- Indexes (REFRESH ... CONCURRENTLY needs a unique one)
+-- ============================================
+CREATE UNIQUE INDEX IF NOT EXISTS idx_activity_rollup_row_id ON analytics_activity_rollup(row_id);
+CREATE UNIQUE INDEX IF NOT EXISTS idx_reaction_rollup_row_id ON analytics_reaction_rollup(row_id);
+CREATE UNIQUE INDEX IF NOT EXISTS idx_activity_minutes_minute ON analytics_activity_minutes(minute);
+
+-- ============================================
+-- Function: refresh_activity_rollups
+-- 3つのビューを1トランザクションで更新（NOW() が揃うので through も一致する）
+-- ============================================
+CREATE OR REPLACE FUNCTION refresh_activity_rollups()
+RETURNS void AS $$
+BEGIN
+    REFRESH MATERIALIZED VIEW CONCURRENTLY analytics_activity_rollup;
+    REFRESH MATERIALIZED VIEW CONCURRENTLY analytics_reaction_rollup;
+    REFRESH MATERIALIZED VIEW CONCURRENTLY analytics_activity_minutes;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER;
+
+-- Refresh every 5 minutes with pg_cron (Database > Extensions で有効化):
+-- SELECT cron.schedule('refresh-activity-rollups', '*/5 * * * *', 'SELECT refresh_activity_rollups()');
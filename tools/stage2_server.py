@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""
+Stage2 classifier service for the C++ TUI
+Stage1 ルールで MISC になったメッセージを OpenAI で info/insight/vibe/ops/misc に分類する
+
+    python tools/stage2_server.py --port 8787
+    COMM0NS_TUI_STAGE2_URL=http://127.0.0.1:8787/classify ./comm0ns_tui
+
+Request:  {"messages": [{"id": "...", "channel": "#dev", "content": "..."}]}
+Response: {"results": [{"id": "...", "category": "insight", "confidence": 0.82}]}
+"""
+from __future__ import annotations
+
+import argparse
+import asyncio
+import json
+import logging
+import os
+import sys
+from pathlib import Path
+
+from aiohttp import web
+from openai import AsyncOpenAI, APIError
+
+project_root = Path(__file__).parent.parent.resolve()
+sys.path.insert(0, str(project_root))
+
+from src.config import config  # noqa: E402
+
+logger = logging.getLogger("stage2")
+
+CATEGORIES = ("info", "insight", "vibe", "ops", "misc")
+
+SYSTEM_PROMPT = """You classify Discord messages of a developer community.
+Categories:
+- info: shares a resource, link, news or a fact others can use
+- insight: an explanation, analysis, design idea or lesson learned
+- vibe: greetings, reactions, jokes, small talk
+- ops: coordination of the community itself (schedules, tasks, governance)
+- misc: anything else
+Answer with JSON only: {"results": [{"id": "<id>", "category": "<category>", "confidence": <0..1>}]}
+with one entry per input message."""
+
+# 同時に OpenAI へ投げるバッチ数（TUI 側のワーカー数より多めでよい）
+MAX_CONCURRENT_REQUESTS = 4
+MAX_CONTENT_CHARS = 1500
+
+
+class Stage2Service:
+    def __init__(self) -> None:
+        self._client = AsyncOpenAI(api_key=config.openai.api_key)
+        self._semaphore = asyncio.Semaphore(MAX_CONCURRENT_REQUESTS)
+
+    async def classify(self, messages: list[dict]) -> list[dict]:
+        prompt = json.dumps(
+            [
+                {"id": str(m.get("id", "")), "channel": m.get("channel", ""), "content": str(m.get("content", ""))[:MAX_CONTENT_CHARS]}
+                for m in messages
+            ],
+            ensure_ascii=False,
+        )
+        async with self._semaphore:
+            response = await self._client.chat.completions.create(
+                model=config.openai.model,
+                messages=[
+                    {"role": "system", "content": SYSTEM_PROMPT},
+                    {"role": "user", "content": prompt},
+                ],
+                response_format={"type": "json_object"},
+                temperature=0,
+            )
+        answer = json.loads(response.choices[0].message.content or "{}")
+        wanted = {str(m.get("id", "")) for m in messages}
+        results = []
+        for r in answer.get("results", []):
+            category = str(r.get("category", "")).lower()
+            if str(r.get("id")) in wanted and category in CATEGORIES:
+                confidence = r.get("confidence", 1.0)
+                if not isinstance(confidence, (int, float)):
+                    confidence = 1.0
+                results.append({"id": str(r["id"]), "category": category, "confidence": max(0.0, min(1.0, float(confidence)))})
+        return results
+
+    async def handle(self, request: web.Request) -> web.Response:
+        token = os.getenv("COMM0NS_TUI_STAGE2_TOKEN", "")
+        if token and request.headers.get("Authorization") != f"Bearer {token}":
+            return web.json_response({"error": "unauthorized"}, status=401)
+        try:
+            body = await request.json()
+        except json.JSONDecodeError:
+            return web.json_response({"error": "invalid json"}, status=400)
+        messages = body.get("messages") if isinstance(body, dict) else None
+        if not isinstance(messages, list):
+            return web.json_response({"error": "messages must be a list"}, status=400)
+        try:
+            results = await self.classify(messages)
+        except (APIError, json.JSONDecodeError) as e:
+            # 5xx を返すと TUI はバッチを再キューしてバックオフする
+            logger.warning("classification failed: %s", e)
+            return web.json_response({"error": str(e)}, status=503)
+        return web.json_response({"results": results})
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="Stage2 classifier for comm0ns_cpp_tui")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8787)
+    args = parser.parse_args()
+    logging.basicConfig(level=logging.INFO, format="%(asctime)s %(levelname)s %(message)s")
+    if not config.openai.api_key:
+        print("Error: OPENAI_API_KEY is not set.", file=sys.stderr)
+        sys.exit(1)
+    service = Stage2Service()
+    app = web.Application(client_max_size=4 * 1024 * 1024)
+    app.router.add_post("/classify", service.handle)
+    web.run_app(app, host=args.host, port=args.port)
+
+
+if __name__ == "__main__":
+    main()